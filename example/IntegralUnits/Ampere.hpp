@@ -34,18 +34,24 @@ using Prefix = LightUnits::Prefix;
 
 constexpr Ampere operator"" _uA(unsigned long long uA)
 {
-    auto val = static_cast<Ampere::ValueType>(uA);
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Ampere, Ampere::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, uA));
+    auto val = Ampere::OverflowPolicy::Narrow<Ampere::ValueType>(uA);
     return Ampere::From<Prefix::Micro>(val);
 }
 
 constexpr Ampere operator"" _mA(unsigned long long mA)
 {
-    auto val = static_cast<Ampere::ValueType>(mA);
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Ampere, Ampere::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, mA));
+    auto val = Ampere::OverflowPolicy::Narrow<Ampere::ValueType>(mA);
     return Ampere::From<Prefix::Milli>(val);
 }
 
 constexpr Ampere operator"" _A(unsigned long long A)
 {
-    auto val = static_cast<Ampere::ValueType>(A);
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Ampere, Ampere::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, A));
+    auto val = Ampere::OverflowPolicy::Narrow<Ampere::ValueType>(A);
     return Ampere::From<Prefix::One>(val);
 }
@@ -20,6 +20,9 @@
 #include "Ampere.hpp"
 #include "Volt.hpp"
 #include "Ohm.hpp"
+#include "Watt.hpp"
+#include "Joule.hpp"
+#include "Second.hpp"
 
 constexpr Volt operator*(Ampere const& lhs, Ohm const& rhs)
 {
@@ -43,4 +46,44 @@ constexpr Ohm operator||(Ohm const& lhs, Ohm const& rhs)
     auto rawr1r2 = static_cast<LightUnits::MultiplicationResultHelper<IntegralValueSystem, Ohm::ValueType, Ohm::ValueType>::type>(raw1)*raw2;
     return  Ohm::From<Ohm::BasePrefix>(
         static_cast<Ohm::ValueType>( rawr1r2 / (raw1+raw2) ));
-} 
+}
+
+constexpr Watt operator*(Volt const& lhs, Ampere const& rhs)
+{
+    return LightUnits::UnitMult<IntegralValueSystem, Watt>(lhs, rhs);
+}
+
+constexpr Watt operator*(Ampere const& lhs, Volt const& rhs)
+{
+    return rhs*lhs;
+}
+
+constexpr Ampere operator/(Watt const& lhs, Volt const& rhs)
+{
+    return LightUnits::UnitDiv<IntegralValueSystem, Ampere>(lhs, rhs);
+}
+
+constexpr Volt operator/(Watt const& lhs, Ampere const& rhs)
+{
+    return LightUnits::UnitDiv<IntegralValueSystem, Volt>(lhs, rhs);
+}
+
+constexpr Joule operator*(Watt const& lhs, Second const& rhs)
+{
+    return LightUnits::UnitMult<IntegralValueSystem, Joule>(lhs, rhs);
+}
+
+constexpr Joule operator*(Second const& lhs, Watt const& rhs)
+{
+    return rhs*lhs;
+}
+
+constexpr Watt operator/(Joule const& lhs, Second const& rhs)
+{
+    return LightUnits::UnitDiv<IntegralValueSystem, Watt>(lhs, rhs);
+}
+
+constexpr Second operator/(Joule const& lhs, Watt const& rhs)
+{
+    return LightUnits::UnitDiv<IntegralValueSystem, Second>(lhs, rhs);
+}
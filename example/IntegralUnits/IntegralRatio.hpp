@@ -0,0 +1,41 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "IntegralValueSystem.hpp"
+#include <LightUnits/BaseUnit.hpp>
+#include <LightUnits/Ratio.hpp>
+
+// Q15.16: range of +-32768 with a resolution of about 1.5e-5
+using IntegralRatio = LightUnits::Ratio<int, 16>;
+
+template<typename Tag, typename Rep>
+constexpr IntegralRatio RatioOf(LightUnits::BaseUnit<Tag, Rep> const& lhs, LightUnits::BaseUnit<Tag, Rep> const& rhs)
+{
+    return LightUnits::UnitRatio<IntegralValueSystem, IntegralRatio>(lhs, rhs);
+}
+
+template<typename Tag, typename Rep>
+constexpr LightUnits::BaseUnit<Tag, Rep> operator*(LightUnits::BaseUnit<Tag, Rep> const& lhs, IntegralRatio const& rhs)
+{
+    return LightUnits::ApplyRatio<IntegralValueSystem>(lhs, rhs);
+}
+
+template<typename Tag, typename Rep>
+constexpr LightUnits::BaseUnit<Tag, Rep> operator*(IntegralRatio const& lhs, LightUnits::BaseUnit<Tag, Rep> const& rhs)
+{
+    return rhs*lhs;
+}
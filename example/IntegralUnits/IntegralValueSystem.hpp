@@ -15,6 +15,7 @@
 
 #pragma once
 
+#include <LightUnits/Int128.hpp>
 #include <LightUnits/ValueSystem.hpp>
 #include <cstdint>
 #include <limits>
@@ -23,7 +24,12 @@
 // long int is also 32-bit on these platforms, but causes different C++ integer promotion rules to apply
 // E.g. for int32_t, you always need to use the long-suffix (1l instead of 1) to prevent an "ambiguous-error" when using this library
 //
+// Int128 (where available) allows UnitMult/UnitDiv on int64 units
+#if defined(LIGHTUNITS_HAS_INT128)
+using IntegralValueSystem = LightUnits::ValueSystem<std::int8_t, std::int16_t, int, std::int64_t, LightUnits::Int128>;
+#else
 using IntegralValueSystem = LightUnits::ValueSystem<std::int8_t, std::int16_t, int, std::int64_t>;
+#endif
 
 static_assert(sizeof(int) == sizeof(std::int32_t), "int is supposed to be a 4-byte type");
 static_assert(std::numeric_limits<int>::max() == std::numeric_limits<std::int32_t>::max(), "int is supposed to be identical to int32_t in range");
@@ -0,0 +1,53 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <LightUnits/TypeTags.hpp>
+#include <LightUnits/BaseUnit.hpp>
+
+// Range of +-2147 kJ (about 596 Wh)
+struct JouleMilliIntegral
+{
+    static LightUnits::Prefix const BasePrefix = LightUnits::Prefix::Milli;
+    typedef std::int32_t ValueType;
+};
+
+typedef LightUnits::BaseUnit<LightUnits::Joule_t, JouleMilliIntegral> Joule;
+
+constexpr Joule operator"" _mJ(unsigned long long mJ)
+{
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Joule, Joule::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, mJ));
+    auto val = Joule::OverflowPolicy::Narrow<Joule::ValueType>(mJ);
+    return Joule::From<LightUnits::Prefix::Milli>(val);
+}
+
+constexpr Joule operator"" _J(unsigned long long J)
+{
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Joule, Joule::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, J));
+    auto val = Joule::OverflowPolicy::Narrow<Joule::ValueType>(J);
+    return Joule::From<LightUnits::Prefix::One>(val);
+}
+
+constexpr Joule operator"" _kJ(unsigned long long kJ)
+{
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Joule, Joule::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, kJ));
+    auto val = Joule::OverflowPolicy::Narrow<Joule::ValueType>(kJ);
+    return Joule::From<LightUnits::Prefix::Kilo>(val);
+}
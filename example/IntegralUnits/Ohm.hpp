@@ -29,18 +29,24 @@ typedef LightUnits::BaseUnit<LightUnits::Ohm_t, OhmMilliIntegral> Ohm;
 
 constexpr Ohm operator"" _mOhm(unsigned long long mOhm)
 {
-    auto val = static_cast<Ohm::ValueType>(mOhm);
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Ohm, Ohm::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, mOhm));
+    auto val = Ohm::OverflowPolicy::Narrow<Ohm::ValueType>(mOhm);
     return Ohm::From<Prefix::Milli>(val);
 }
 
 constexpr Ohm operator"" _Ohm(unsigned long long ohm)
 {
-    auto val = static_cast<Ohm::ValueType>(ohm);
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Ohm, Ohm::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, ohm));
+    auto val = Ohm::OverflowPolicy::Narrow<Ohm::ValueType>(ohm);
     return Ohm::From<Prefix::One>(val);
 }
 
 constexpr Ohm operator"" _kOhm(unsigned long long kOhm)
 {
-    auto val = static_cast<Ohm::ValueType>(kOhm);
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Ohm, Ohm::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, kOhm));
+    auto val = Ohm::OverflowPolicy::Narrow<Ohm::ValueType>(kOhm);
     return Ohm::From<Prefix::Kilo>(val);
 }
@@ -0,0 +1,53 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <LightUnits/TypeTags.hpp>
+#include <LightUnits/BaseUnit.hpp>
+
+// Range of +-2147 s, intended for relative timestamps and durations
+struct SecondMicroIntegral
+{
+    static LightUnits::Prefix const BasePrefix = LightUnits::Prefix::Micro;
+    typedef std::int32_t ValueType;
+};
+
+typedef LightUnits::BaseUnit<LightUnits::Second_t, SecondMicroIntegral> Second;
+
+constexpr Second operator"" _us(unsigned long long us)
+{
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Second, Second::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, us));
+    auto val = Second::OverflowPolicy::Narrow<Second::ValueType>(us);
+    return Second::From<LightUnits::Prefix::Micro>(val);
+}
+
+constexpr Second operator"" _ms(unsigned long long ms)
+{
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Second, Second::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, ms));
+    auto val = Second::OverflowPolicy::Narrow<Second::ValueType>(ms);
+    return Second::From<LightUnits::Prefix::Milli>(val);
+}
+
+constexpr Second operator"" _s(unsigned long long s)
+{
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Second, Second::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, s));
+    auto val = Second::OverflowPolicy::Narrow<Second::ValueType>(s);
+    return Second::From<LightUnits::Prefix::One>(val);
+}
@@ -29,12 +29,16 @@ typedef LightUnits::BaseUnit<LightUnits::Volt_t, VoltMilliIntegral> Volt;
 
 constexpr Volt operator"" _mV(unsigned long long mV)
 {
-    auto val = static_cast<Volt::ValueType>(mV);
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Volt, Volt::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, mV));
+    auto val = Volt::OverflowPolicy::Narrow<Volt::ValueType>(mV);
     return Volt::From<Prefix::Milli>(val);
 }
 
 constexpr Volt operator"" _V(unsigned long long V)
 {
-    auto val = static_cast<Volt::ValueType>(V);
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Volt, Volt::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, V));
+    auto val = Volt::OverflowPolicy::Narrow<Volt::ValueType>(V);
     return Volt::From<Prefix::One>(val);
 }
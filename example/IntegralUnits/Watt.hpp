@@ -0,0 +1,52 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <LightUnits/TypeTags.hpp>
+#include <LightUnits/BaseUnit.hpp>
+
+struct WattMilliIntegral
+{
+    static LightUnits::Prefix const BasePrefix = LightUnits::Prefix::Milli;
+    typedef std::int32_t ValueType;
+};
+
+typedef LightUnits::BaseUnit<LightUnits::Watt_t, WattMilliIntegral> Watt;
+
+constexpr Watt operator"" _mW(unsigned long long mW)
+{
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Watt, Watt::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, mW));
+    auto val = Watt::OverflowPolicy::Narrow<Watt::ValueType>(mW);
+    return Watt::From<LightUnits::Prefix::Milli>(val);
+}
+
+constexpr Watt operator"" _W(unsigned long long W)
+{
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Watt, Watt::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, W));
+    auto val = Watt::OverflowPolicy::Narrow<Watt::ValueType>(W);
+    return Watt::From<LightUnits::Prefix::One>(val);
+}
+
+constexpr Watt operator"" _kW(unsigned long long kW)
+{
+    LIGHTUNITS_INSTRUMENT(LightUnits::instrumentation::detail::CheckNarrow<Watt, Watt::ValueType>(
+            LightUnits::instrumentation::Operation::Literal, kW));
+    auto val = Watt::OverflowPolicy::Narrow<Watt::ValueType>(kW);
+    return Watt::From<LightUnits::Prefix::Kilo>(val);
+}
@@ -0,0 +1,706 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "Int128.hpp"
+#include "UnitSpan.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// Chunked on-disk archive of unit time series (POSIX only)
+///
+/// File layout, all values in native byte order:
+///   [header, 4096 bytes][chunk 0][chunk 1]...
+/// Every chunk occupies the same number of bytes, so chunk i starts at 4096 + i * chunkBytes:
+///   [chunk header: rows, first and last time][one summary (min, max, sum) per column][column 0]...[column N]
+/// The sums are 128 bit two's complement (low word first), so int64 columns such as nanosecond timestamps cannot
+/// overflow them.
+/// Column 0 always is the time column. Each column holds chunkRows raw values and starts 64 byte aligned.
+///
+/// Appends are crash-safe: a chunk is written and synced before the committed chunk count in the header is
+/// updated and synced. Data past the committed count is ignored by readers and discarded by writers.
+
+namespace LightUnits {
+    /// Aggregate of the raw values of one column, in the unit's BasePrefix
+    template<typename Unit>
+    struct ColumnSummary {
+        Unit min;
+        Unit max;
+        WideSum rawSum;
+        std::uint64_t rows;
+
+        /// Arithmetic mean, truncated towards zero. Undefined for rows == 0.
+        Unit Mean() const {
+            return Unit::template From<Unit::BasePrefix>(rawSum.Mean<typename Unit::ValueType>(rows));
+        }
+    };
+
+    /// Rows [begin, end) of one chunk, see ArchiveReader::Query
+    struct ArchiveSlice {
+        std::size_t chunk;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    namespace detail {
+        constexpr char ArchiveMagic[8] = {'L', 'U', 'A', 'R', 'C', 'H', 'I', 'V'};
+        constexpr std::uint32_t ArchiveVersion = 2;
+        constexpr std::size_t ArchiveHeaderBytes = 4096;
+        constexpr std::size_t ArchiveAlignment = 64;
+        constexpr std::size_t ArchiveMaxColumns = 256;
+
+        struct ArchiveColumnDesc {
+            std::uint32_t size;
+            std::int32_t prefix;
+        };
+
+        struct ArchiveHeader {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t columnCount;
+            std::uint64_t chunkRows;
+            std::uint64_t chunkBytes;
+            std::uint64_t committedChunks;
+            ArchiveColumnDesc columns[ArchiveMaxColumns];
+        };
+
+        static_assert(sizeof(ArchiveHeader) <= ArchiveHeaderBytes, "Archive header exceeds its reserved space");
+
+        struct ArchiveChunkHeader {
+            std::uint64_t rows;
+            std::int64_t firstTime;
+            std::int64_t lastTime;
+            std::uint64_t reserved;
+        };
+
+        struct ArchiveSummary {
+            std::int64_t min;
+            std::int64_t max;
+            WideSum sum;
+        };
+
+        static_assert(sizeof(ArchiveSummary) == 32, "Archive summaries have to be stored without padding");
+
+        constexpr std::size_t ArchiveCommittedOffset = offsetof(ArchiveHeader, committedChunks);
+
+        constexpr std::size_t AlignUp(std::size_t val, std::size_t alignment) {
+            return (val + alignment - 1) / alignment * alignment;
+        }
+
+        [[noreturn]] inline void ThrowSystemError(std::string const &what) {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        /// Byte offsets within a chunk, identical for writer and reader
+        template<typename ... Columns>
+        class ArchiveLayout {
+        public:
+            static constexpr std::size_t ColumnCount = sizeof...(Columns);
+
+            explicit ArchiveLayout(std::size_t chunkRows)
+                    : m_chunkRows(chunkRows) {
+                std::size_t const sizes[] = {sizeof(Columns)...};
+                std::size_t offset = sizeof(ArchiveChunkHeader) + ColumnCount * sizeof(ArchiveSummary);
+                for (std::size_t i = 0; i < ColumnCount; ++i) {
+                    offset = AlignUp(offset, ArchiveAlignment);
+                    m_columnOffsets[i] = offset;
+                    offset += sizes[i] * chunkRows;
+                }
+                m_chunkBytes = AlignUp(offset, ArchiveAlignment);
+            }
+
+            std::size_t ChunkRows() const {
+                return m_chunkRows;
+            }
+
+            std::size_t ChunkBytes() const {
+                return m_chunkBytes;
+            }
+
+            static std::size_t SummaryOffset(std::size_t column) {
+                return sizeof(ArchiveChunkHeader) + column * sizeof(ArchiveSummary);
+            }
+
+            std::size_t ColumnOffset(std::size_t column) const {
+                return m_columnOffsets[column];
+            }
+
+            static void Describe(ArchiveHeader &header) {
+                ArchiveColumnDesc const columns[] = {
+                        {static_cast<std::uint32_t>(sizeof(Columns)), static_cast<std::int32_t>(Columns::BasePrefix)}...};
+                header.columnCount = static_cast<std::uint32_t>(ColumnCount);
+                std::copy(columns, columns + ColumnCount, header.columns);
+            }
+
+            static bool Matches(ArchiveHeader const &header) {
+                ArchiveHeader expected = {};
+                Describe(expected);
+                return header.columnCount == expected.columnCount &&
+                       std::equal(expected.columns, expected.columns + ColumnCount, header.columns,
+                                  [](ArchiveColumnDesc const &lhs, ArchiveColumnDesc const &rhs) {
+                                      return lhs.size == rhs.size && lhs.prefix == rhs.prefix;
+                                  });
+            }
+
+        private:
+            std::size_t m_chunkRows;
+            std::size_t m_chunkBytes = 0;
+            std::size_t m_columnOffsets[ColumnCount] = {};
+        };
+
+        template<typename Unit>
+        ArchiveSummary Summarize(Unit const *values, std::size_t rows) {
+            ArchiveSummary summary = {std::numeric_limits<std::int64_t>::max(),
+                                      std::numeric_limits<std::int64_t>::min(), WideSum()};
+            for (std::size_t i = 0; i < rows; ++i) {
+                std::int64_t const raw = values[i].template To<Unit::BasePrefix>();
+                summary.min = std::min(summary.min, raw);
+                summary.max = std::max(summary.max, raw);
+                summary.sum.Add(raw);
+            }
+            return summary;
+        }
+
+        inline void Combine(ArchiveSummary &total, std::uint64_t &totalRows, ArchiveSummary const &part,
+                            std::uint64_t partRows) {
+            if (partRows == 0) {
+                return;
+            }
+            total.min = std::min(total.min, part.min);
+            total.max = std::max(total.max, part.max);
+            total.sum.Add(part.sum);
+            totalRows += partRows;
+        }
+
+        template<typename Unit>
+        ColumnSummary<Unit> ToColumnSummary(ArchiveSummary const &summary, std::uint64_t rows) {
+            using ValueType = typename Unit::ValueType;
+            if (rows == 0) {
+                return {Unit::template From<Unit::BasePrefix>(0), Unit::template From<Unit::BasePrefix>(0),
+                        WideSum(), 0};
+            }
+            return {Unit::template From<Unit::BasePrefix>(static_cast<ValueType>(summary.min)),
+                    Unit::template From<Unit::BasePrefix>(static_cast<ValueType>(summary.max)), summary.sum, rows};
+        }
+
+        /// Owning file descriptor
+        class ArchiveFile {
+        public:
+            ArchiveFile(std::string const &path, int flags)
+                    : m_fd(::open(path.c_str(), flags | O_CLOEXEC, 0644)) {
+                if (m_fd < 0) {
+                    ThrowSystemError("Cannot open archive " + path);
+                }
+            }
+
+            ArchiveFile(ArchiveFile &&other) noexcept
+                    : m_fd(other.m_fd) {
+                other.m_fd = -1;
+            }
+
+            ArchiveFile &operator=(ArchiveFile &&other) noexcept {
+                std::swap(m_fd, other.m_fd);
+                return *this;
+            }
+
+            ~ArchiveFile() {
+                if (m_fd >= 0) {
+                    ::close(m_fd);
+                }
+            }
+
+            int Descriptor() const {
+                return m_fd;
+            }
+
+            std::size_t Size() const {
+                struct stat info;
+                if (::fstat(m_fd, &info) != 0) {
+                    ThrowSystemError("Cannot stat archive");
+                }
+                return static_cast<std::size_t>(info.st_size);
+            }
+
+            void Read(void *data, std::size_t size, std::size_t offset) const {
+                auto *bytes = static_cast<char *>(data);
+                while (size > 0) {
+                    ssize_t const done = ::pread(m_fd, bytes, size, static_cast<off_t>(offset));
+                    if (done < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    if (done <= 0) {
+                        ThrowSystemError("Cannot read archive");
+                    }
+                    bytes += done;
+                    size -= static_cast<std::size_t>(done);
+                    offset += static_cast<std::size_t>(done);
+                }
+            }
+
+            void Write(void const *data, std::size_t size, std::size_t offset) {
+                auto const *bytes = static_cast<char const *>(data);
+                while (size > 0) {
+                    ssize_t const done = ::pwrite(m_fd, bytes, size, static_cast<off_t>(offset));
+                    if (done < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    if (done < 0) {
+                        ThrowSystemError("Cannot write archive");
+                    }
+                    bytes += done;
+                    size -= static_cast<std::size_t>(done);
+                    offset += static_cast<std::size_t>(done);
+                }
+            }
+
+            void Truncate(std::size_t size) {
+                if (::ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+                    ThrowSystemError("Cannot truncate archive");
+                }
+            }
+
+            void Sync() {
+                if (::fsync(m_fd) != 0) {
+                    ThrowSystemError("Cannot sync archive");
+                }
+            }
+
+        private:
+            int m_fd;
+        };
+
+        /// Reads the header and checks it against the expected layout
+        template<typename ... Columns>
+        ArchiveHeader ReadArchiveHeader(ArchiveFile const &file) {
+            ArchiveHeader header = {};
+            if (file.Size() < ArchiveHeaderBytes) {
+                throw std::runtime_error("Archive is truncated");
+            }
+            file.Read(&header, sizeof(header), 0);
+            if (!std::equal(header.magic, header.magic + sizeof(header.magic), ArchiveMagic) ||
+                header.version != ArchiveVersion) {
+                throw std::runtime_error("File is not a LightUnits archive");
+            }
+            if (!ArchiveLayout<Columns...>::Matches(header) || header.chunkRows == 0 ||
+                header.chunkBytes != ArchiveLayout<Columns...>(header.chunkRows).ChunkBytes()) {
+                throw std::runtime_error("Archive columns do not match");
+            }
+            return header;
+        }
+    }
+
+    /// @brief Appends rows to an archive, one chunk at a time
+    ///
+    /// Rows are buffered in memory and written as soon as chunkRows rows are available. Flush() writes the
+    /// buffered rows as a shorter chunk, e.g. before shutdown; later rows start a new chunk.
+    /// Time has to be non-decreasing across all rows, also across reopening.
+    ///
+    /// Opening an existing archive continues it. The chunk size stored in the file takes precedence then, and
+    /// chunks which were not committed before a crash are discarded.
+    ///
+    /// Errors are reported by std::system_error (I/O), std::runtime_error (format) and std::invalid_argument
+    /// (rows out of time order).
+    ///
+    template<typename Time, typename ... Columns>
+    class ArchiveWriter {
+        using Layout = detail::ArchiveLayout<Time, Columns...>;
+
+    public:
+        static constexpr std::size_t ColumnCount = sizeof...(Columns) + 1;
+
+        template<std::size_t I>
+        using ColumnType = typename std::tuple_element<I, std::tuple<Time, Columns...>>::type;
+
+        explicit ArchiveWriter(std::string const &path, std::size_t chunkRows = 4096)
+                : m_file(path, O_RDWR | O_CREAT),
+                  m_layout(chunkRows) {
+            if (m_file.Size() == 0) {
+                assert(chunkRows > 0);
+                CreateHeader();
+            } else {
+                auto const header = detail::ReadArchiveHeader<Time, Columns...>(m_file);
+                m_layout = Layout(header.chunkRows);
+                m_committed = header.committedChunks;
+                m_file.Truncate(ChunkOffset(m_committed));
+                if (m_committed > 0) {
+                    detail::ArchiveChunkHeader last = {};
+                    m_file.Read(&last, sizeof(last), ChunkOffset(m_committed - 1));
+                    m_lastTime = last.lastTime;
+                }
+            }
+            Reserve(std::index_sequence_for<Time, Columns...>());
+            m_chunk.resize(m_layout.ChunkBytes());
+        }
+
+        ArchiveWriter(ArchiveWriter const &) = delete;
+
+        ArchiveWriter &operator=(ArchiveWriter const &) = delete;
+
+        /// Flushes the buffered rows; call Flush() explicitly to observe errors
+        ~ArchiveWriter() {
+            try {
+                Flush();
+            } catch (...) {
+            }
+        }
+
+        /// Throws std::invalid_argument if time is before the time of the previous row; nothing is appended then
+        void AppendRow(Time const &time, Columns const &... values) {
+            if (time.template To<Time::BasePrefix>() < m_lastTime) {
+                throw std::invalid_argument("Archive rows have to be appended in time order");
+            }
+            m_lastTime = time.template To<Time::BasePrefix>();
+
+            AppendRowImpl(std::index_sequence_for<Time, Columns...>(), time, values...);
+            if (++m_buffered == m_layout.ChunkRows()) {
+                Flush();
+            }
+        }
+
+        /// Writes and commits the buffered rows
+        void Flush() {
+            if (m_buffered == 0) {
+                return;
+            }
+
+            std::fill(m_chunk.begin(), m_chunk.end(), 0);
+            auto const &time = std::get<0>(m_columns);
+            detail::ArchiveChunkHeader const header = {m_buffered, time.front().template To<Time::BasePrefix>(),
+                                                       time.back().template To<Time::BasePrefix>(), 0};
+            std::memcpy(m_chunk.data(), &header, sizeof(header));
+            SerializeColumns(std::index_sequence_for<Time, Columns...>());
+
+            // Chunk first, then the count which makes it visible
+            m_file.Write(m_chunk.data(), m_chunk.size(), ChunkOffset(m_committed));
+            m_file.Sync();
+            std::uint64_t const committed = m_committed + 1;
+            m_file.Write(&committed, sizeof(committed), detail::ArchiveCommittedOffset);
+            m_file.Sync();
+
+            m_committed = committed;
+            m_buffered = 0;
+            Clear(std::index_sequence_for<Time, Columns...>());
+        }
+
+        std::size_t CommittedChunks() const {
+            return m_committed;
+        }
+
+        std::size_t BufferedRows() const {
+            return m_buffered;
+        }
+
+    private:
+        std::size_t ChunkOffset(std::size_t chunk) const {
+            return detail::ArchiveHeaderBytes + chunk * m_layout.ChunkBytes();
+        }
+
+        void CreateHeader() {
+            std::vector<char> bytes(detail::ArchiveHeaderBytes, 0);
+            detail::ArchiveHeader header = {};
+            std::copy(detail::ArchiveMagic, detail::ArchiveMagic + sizeof(header.magic), header.magic);
+            header.version = detail::ArchiveVersion;
+            header.chunkRows = m_layout.ChunkRows();
+            header.chunkBytes = m_layout.ChunkBytes();
+            header.committedChunks = 0;
+            Layout::Describe(header);
+            std::memcpy(bytes.data(), &header, sizeof(header));
+
+            m_file.Write(bytes.data(), bytes.size(), 0);
+            m_file.Sync();
+        }
+
+        template<std::size_t ... I>
+        void Reserve(std::index_sequence<I...>) {
+            (void) std::initializer_list<int>{(std::get<I>(m_columns).reserve(m_layout.ChunkRows()), 0)...};
+        }
+
+        template<std::size_t ... I>
+        void Clear(std::index_sequence<I...>) {
+            (void) std::initializer_list<int>{(std::get<I>(m_columns).clear(), 0)...};
+        }
+
+        template<std::size_t ... I>
+        void AppendRowImpl(std::index_sequence<I...>, Time const &time, Columns const &... values) {
+            auto const row = std::forward_as_tuple(time, values...);
+            (void) std::initializer_list<int>{(std::get<I>(m_columns).push_back(std::get<I>(row)), 0)...};
+        }
+
+        template<std::size_t ... I>
+        void SerializeColumns(std::index_sequence<I...>) {
+            (void) std::initializer_list<int>{(SerializeColumn<I>(), 0)...};
+        }
+
+        template<std::size_t I>
+        void SerializeColumn() {
+            auto const &column = std::get<I>(m_columns);
+            auto const summary = detail::Summarize(column.data(), column.size());
+            std::memcpy(m_chunk.data() + Layout::SummaryOffset(I), &summary, sizeof(summary));
+            std::memcpy(m_chunk.data() + m_layout.ColumnOffset(I), column.data(),
+                        column.size() * sizeof(ColumnType<I>));
+        }
+
+        detail::ArchiveFile m_file;
+        Layout m_layout;
+        std::tuple<std::vector<Time>, std::vector<Columns>...> m_columns;
+        std::vector<char> m_chunk;
+        std::uint64_t m_committed = 0;
+        std::uint64_t m_buffered = 0;
+        std::int64_t m_lastTime = std::numeric_limits<std::int64_t>::min();
+    };
+
+    template<typename Time, typename ... Columns>
+    constexpr std::size_t ArchiveWriter<Time, Columns...>::ColumnCount;
+
+    /// @brief Read-only, memory-mapped view of an archive
+    ///
+    /// Column() returns views into the mapping, nothing is copied. Only the pages which are accessed are read
+    /// from disk: time lookups touch the chunk headers and the time column of the boundary chunks, and
+    /// CoarseAggregate() touches the chunk headers and summaries only.
+    ///
+    /// The reader sees the chunks which were committed when it was opened. Column 0 is the time column.
+    ///
+    template<typename Time, typename ... Columns>
+    class ArchiveReader {
+        using Layout = detail::ArchiveLayout<Time, Columns...>;
+
+    public:
+        static constexpr std::size_t ColumnCount = sizeof...(Columns) + 1;
+
+        template<std::size_t I>
+        using ColumnType = typename std::tuple_element<I, std::tuple<Time, Columns...>>::type;
+
+        explicit ArchiveReader(std::string const &path)
+                : m_layout(1) {
+            detail::ArchiveFile file(path, O_RDONLY);
+            auto const header = detail::ReadArchiveHeader<Time, Columns...>(file);
+            m_layout = Layout(header.chunkRows);
+
+            // Chunks whose commit is pending may be incomplete on disk
+            m_chunks = std::min<std::size_t>(header.committedChunks,
+                                             (file.Size() - detail::ArchiveHeaderBytes) / m_layout.ChunkBytes());
+            m_size = detail::ArchiveHeaderBytes + m_chunks * m_layout.ChunkBytes();
+
+            void *mapping = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, file.Descriptor(), 0);
+            if (mapping == MAP_FAILED) {
+                detail::ThrowSystemError("Cannot map archive " + path);
+            }
+            m_data = static_cast<char const *>(mapping);
+        }
+
+        ArchiveReader(ArchiveReader &&other) noexcept
+                : m_layout(other.m_layout), m_data(other.m_data), m_size(other.m_size), m_chunks(other.m_chunks) {
+            other.m_data = nullptr;
+        }
+
+        ArchiveReader &operator=(ArchiveReader &&other) noexcept {
+            std::swap(m_layout, other.m_layout);
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+            std::swap(m_chunks, other.m_chunks);
+            return *this;
+        }
+
+        ~ArchiveReader() {
+            if (m_data != nullptr) {
+                ::munmap(const_cast<char *>(m_data), m_size);
+            }
+        }
+
+        std::size_t Chunks() const {
+            return m_chunks;
+        }
+
+        std::size_t ChunkRows(std::size_t chunk) const {
+            return static_cast<std::size_t>(ChunkHeader(chunk).rows);
+        }
+
+        std::size_t Rows() const {
+            std::size_t rows = 0;
+            for (std::size_t chunk = 0; chunk < m_chunks; ++chunk) {
+                rows += ChunkRows(chunk);
+            }
+            return rows;
+        }
+
+        /// All values of column I in the given chunk, pointing into the mapping
+        template<std::size_t I>
+        UnitSpan<ColumnType<I> const> Column(std::size_t chunk) const {
+            assert(chunk < m_chunks);
+            auto const *values = reinterpret_cast<ColumnType<I> const *>(ChunkData(chunk) + m_layout.ColumnOffset(I));
+            return MakeSpan(values, ChunkRows(chunk));
+        }
+
+        /// Values of column I in the rows of slice
+        template<std::size_t I>
+        UnitSpan<ColumnType<I> const> Column(ArchiveSlice const &slice) const {
+            return Column<I>(slice.chunk).subspan(slice.begin, slice.end - slice.begin);
+        }
+
+        /// Stored summary of column I in the given chunk
+        template<std::size_t I>
+        ColumnSummary<ColumnType<I>> Summary(std::size_t chunk) const {
+            return detail::ToColumnSummary<ColumnType<I>>(StoredSummary(chunk, I), ChunkRows(chunk));
+        }
+
+        /// @brief Row ranges with from <= time <= to, in time order
+        ///
+        /// Chunks are located by binary search over the chunk headers, rows by binary search in the time column
+        /// of the first and last chunk only.
+        ///
+        std::vector<ArchiveSlice> Query(Time const &from, Time const &to) const {
+            std::vector<ArchiveSlice> slices;
+            auto const range = ChunkRange(from, to);
+            for (std::size_t chunk = range.first; chunk < range.second; ++chunk) {
+                slices.push_back(Slice(chunk, from, to));
+            }
+            return slices;
+        }
+
+        /// @brief Exact aggregate of column I over the rows with from <= time <= to
+        ///
+        /// Chunks completely inside the range contribute their stored summary, only the rows of partially
+        /// covered chunks are scanned.
+        ///
+        template<std::size_t I>
+        ColumnSummary<ColumnType<I>> Aggregate(Time const &from, Time const &to) const {
+            detail::ArchiveSummary total = EmptySummary();
+            std::uint64_t rows = 0;
+
+            auto const range = ChunkRange(from, to);
+            for (std::size_t chunk = range.first; chunk < range.second; ++chunk) {
+                auto const &header = ChunkHeader(chunk);
+                if (header.firstTime >= Raw(from) && header.lastTime <= Raw(to)) {
+                    detail::Combine(total, rows, StoredSummary(chunk, I), header.rows);
+                } else {
+                    auto const slice = Slice(chunk, from, to);
+                    auto const values = Column<I>(slice);
+                    detail::Combine(total, rows, detail::Summarize(values.data(), values.size()), values.size());
+                }
+            }
+            return detail::ToColumnSummary<ColumnType<I>>(total, rows);
+        }
+
+        /// @brief Aggregate of column I over all chunks overlapping [from, to], from the stored summaries only
+        ///
+        /// The result covers whole chunks, i.e. up to one chunk of rows before and after the range in addition.
+        ///
+        template<std::size_t I>
+        ColumnSummary<ColumnType<I>> CoarseAggregate(Time const &from, Time const &to) const {
+            detail::ArchiveSummary total = EmptySummary();
+            std::uint64_t rows = 0;
+
+            auto const range = ChunkRange(from, to);
+            for (std::size_t chunk = range.first; chunk < range.second; ++chunk) {
+                detail::Combine(total, rows, StoredSummary(chunk, I), ChunkHeader(chunk).rows);
+            }
+            return detail::ToColumnSummary<ColumnType<I>>(total, rows);
+        }
+
+    private:
+        static std::int64_t Raw(Time const &time) {
+            return time.template To<Time::BasePrefix>();
+        }
+
+        static detail::ArchiveSummary EmptySummary() {
+            return {std::numeric_limits<std::int64_t>::max(), std::numeric_limits<std::int64_t>::min(), WideSum()};
+        }
+
+        char const *ChunkData(std::size_t chunk) const {
+            return m_data + detail::ArchiveHeaderBytes + chunk * m_layout.ChunkBytes();
+        }
+
+        detail::ArchiveChunkHeader ChunkHeader(std::size_t chunk) const {
+            detail::ArchiveChunkHeader header;
+            std::memcpy(&header, ChunkData(chunk), sizeof(header));
+            return header;
+        }
+
+        detail::ArchiveSummary StoredSummary(std::size_t chunk, std::size_t column) const {
+            detail::ArchiveSummary summary;
+            std::memcpy(&summary, ChunkData(chunk) + Layout::SummaryOffset(column), sizeof(summary));
+            return summary;
+        }
+
+        /// Chunks [first, second) which may hold rows with from <= time <= to
+        std::pair<std::size_t, std::size_t> ChunkRange(Time const &from, Time const &to) const {
+            // Times are non-decreasing, so are first and last time of consecutive chunks
+            std::size_t low = 0;
+            std::size_t high = m_chunks;
+            while (low < high) {
+                std::size_t const mid = low + (high - low) / 2;
+                if (ChunkHeader(mid).lastTime < Raw(from)) {
+                    low = mid + 1;
+                } else {
+                    high = mid;
+                }
+            }
+            std::size_t const first = low;
+
+            high = m_chunks;
+            while (low < high) {
+                std::size_t const mid = low + (high - low) / 2;
+                if (ChunkHeader(mid).firstTime <= Raw(to)) {
+                    low = mid + 1;
+                } else {
+                    high = mid;
+                }
+            }
+            return {first, std::max(first, low)};
+        }
+
+        ArchiveSlice Slice(std::size_t chunk, Time const &from, Time const &to) const {
+            auto const times = Column<0>(chunk);
+            auto const header = ChunkHeader(chunk);
+
+            std::size_t begin = 0;
+            if (header.firstTime < Raw(from)) {
+                begin = static_cast<std::size_t>(std::lower_bound(times.begin(), times.end(), from) - times.begin());
+            }
+            std::size_t end = times.size();
+            if (header.lastTime > Raw(to)) {
+                end = static_cast<std::size_t>(std::upper_bound(times.begin(), times.end(), to) - times.begin());
+            }
+            return {chunk, begin, std::max(begin, end)};
+        }
+
+        Layout m_layout;
+        char const *m_data = nullptr;
+        std::size_t m_size = 0;
+        std::size_t m_chunks = 0;
+    };
+
+    template<typename Time, typename ... Columns>
+    constexpr std::size_t ArchiveReader<Time, Columns...>::ColumnCount;
+}
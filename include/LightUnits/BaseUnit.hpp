@@ -17,6 +17,8 @@
 
 #include "Prefix.hpp"
 #include "MultiplyWithExponent.hpp"
+#include "Instrumentation.hpp"
+#include "OverflowPolicy.hpp"
 #include <limits>
 
 namespace LightUnits {
@@ -25,36 +27,51 @@ namespace LightUnits {
     public:
         using ValueType = typename T_Representation::ValueType;
 
+        /// WrapOverflow unless the representation defines OverflowPolicy, see OverflowPolicy.hpp
+        using OverflowPolicy = typename detail::OverflowPolicyOf<T_Representation>::type;
+
         BaseUnit() = default;
 
         BaseUnit(BaseUnit const&) = default;
 
         /// Arithmetic operators
         inline constexpr BaseUnit &operator+=(BaseUnit const &rhs) {
-            m_value += rhs.Raw();
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckAdd<BaseUnit>(
+                    instrumentation::Operation::Add, m_value, rhs.Raw()));
+            m_value = OverflowPolicy::Add(m_value, rhs.Raw());
             return *this;
         }
 
         inline constexpr BaseUnit &operator-=(BaseUnit const &rhs) {
-            m_value -= rhs.Raw();
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckSub<BaseUnit>(
+                    instrumentation::Operation::Subtract, m_value, rhs.Raw()));
+            m_value = OverflowPolicy::Sub(m_value, rhs.Raw());
             return *this;
         }
 
         inline constexpr BaseUnit operator-() const {
-            return BaseUnit(-m_value);
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckNegate<BaseUnit>(
+                    instrumentation::Operation::Negate, m_value));
+            return BaseUnit(OverflowPolicy::Negate(m_value));
         }
 
         inline constexpr BaseUnit operator+(BaseUnit const &rhs) const {
-            return BaseUnit(m_value + rhs.Raw());
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckAdd<BaseUnit>(
+                    instrumentation::Operation::Add, m_value, rhs.Raw()));
+            return BaseUnit(OverflowPolicy::Add(m_value, rhs.Raw()));
         }
 
         inline constexpr BaseUnit operator-(BaseUnit const &rhs) const {
-            return BaseUnit(m_value - rhs.Raw());
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckSub<BaseUnit>(
+                    instrumentation::Operation::Subtract, m_value, rhs.Raw()));
+            return BaseUnit(OverflowPolicy::Sub(m_value, rhs.Raw()));
         }
 
 
         friend inline constexpr BaseUnit operator*(BaseUnit const &lhs, ValueType const &rhs) {
-            return BaseUnit(lhs.m_value * rhs);
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckMul<BaseUnit>(
+                    instrumentation::Operation::Multiply, lhs.m_value, rhs));
+            return BaseUnit(OverflowPolicy::Mul(lhs.m_value, rhs));
         }
 
         friend inline constexpr BaseUnit operator*(ValueType const &lhs, BaseUnit const &rhs) {
@@ -64,7 +81,9 @@ namespace LightUnits {
         friend inline constexpr BaseUnit operator*(BaseUnit const& lhs, float const& rhs)
         {
             float scaled = rhs * lhs.m_value;
-            return BaseUnit(static_cast<ValueType>(scaled));
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckFloat<BaseUnit, ValueType>(
+                    instrumentation::Operation::Multiply, scaled));
+            return BaseUnit(OverflowPolicy::template FromFloat<ValueType>(scaled));
         }
 
         friend inline constexpr BaseUnit operator*(float const& lhs, BaseUnit const& rhs)
@@ -77,12 +96,16 @@ namespace LightUnits {
         }
 
         friend inline constexpr BaseUnit operator/(BaseUnit const &lhs, ValueType const &rhs) {
-            return BaseUnit(lhs.m_value / rhs);
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckDiv<BaseUnit>(
+                    instrumentation::Operation::Divide, lhs.m_value, rhs));
+            return BaseUnit(OverflowPolicy::Div(lhs.m_value, rhs));
         }
 
         friend inline constexpr BaseUnit operator/(BaseUnit const &lhs, float const &rhs) {
             float scaled = lhs.m_value / rhs;
-            return BaseUnit(static_cast<ValueType>(scaled));
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckFloat<BaseUnit, ValueType>(
+                    instrumentation::Operation::Divide, scaled));
+            return BaseUnit(OverflowPolicy::template FromFloat<ValueType>(scaled));
         }
 
         /// Modulo operator for Unit modulo Unit returns Unit
@@ -127,7 +150,10 @@ namespace LightUnits {
 
         template<Prefix source>
         static constexpr BaseUnit From(ValueType val) {
-            ValueType res = detail::MultiplyWithExponent<
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckScale<
+                    BaseUnit, detail::DecadesDiff(source, T_Representation::BasePrefix)>(
+                    instrumentation::Operation::From, val));
+            ValueType res = OverflowPolicy::template Scale<
                     detail::DecadesDiff(source, T_Representation::BasePrefix)>(val);
             return BaseUnit(res);
         }
@@ -141,12 +167,18 @@ namespace LightUnits {
         static constexpr BaseUnit FromFloat(float val) {
             constexpr int exp = detail::DecadesDiff(Prefix::One, T_Representation::BasePrefix);
             float val_correctExp = val * detail::ExponentToMultiplier<exp>::value;
-            return BaseUnit::From<T_Representation::BasePrefix>( static_cast<BaseUnit::ValueType>(val_correctExp));
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckFloat<BaseUnit, ValueType>(
+                    instrumentation::Operation::FromFloat, val_correctExp));
+            return BaseUnit::From<T_Representation::BasePrefix>(
+                    OverflowPolicy::template FromFloat<BaseUnit::ValueType>(val_correctExp));
         }
 
         template<Prefix target>
         constexpr ValueType To() const {
-            return detail::MultiplyWithExponent<
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckScale<
+                    BaseUnit, detail::DecadesDiff(T_Representation::BasePrefix, target)>(
+                    instrumentation::Operation::To, m_value));
+            return OverflowPolicy::template Scale<
                     detail::DecadesDiff(T_Representation::BasePrefix, target)>(m_value);
         }
 
@@ -173,6 +205,17 @@ namespace LightUnits {
 
         friend class std::numeric_limits<LightUnits::BaseUnit<TypeTag, T_Representation>>;
     };
+
+    namespace detail {
+        /// @brief Yields the TypeTag of a BaseUnit, e.g. to restrict functions to one kind of unit
+        template<typename Unit>
+        struct UnitTag;
+
+        template<typename Tag, typename Rep>
+        struct UnitTag<BaseUnit<Tag, Rep>> {
+            using type = Tag;
+        };
+    }
 }
 
 namespace std
@@ -0,0 +1,291 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "OverflowPolicy.hpp"
+#include "Prefix.hpp"
+#include "UnitSpan.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// Element-wise arithmetic on unit buffers, following the OverflowPolicy of the unit
+///
+/// For units with SaturateOverflow, the kernels use the saturating SSE2 instructions where available:
+/// paddsb/paddsw (and psubs) for 8/16 bit values, packssdw for narrowing 32 to 16 bit. 32 bit additions are
+/// saturated branch-free from the sign bits. The saturation costs no per-element branches then.
+/// All other cases use the scalar policy functions.
+///
+/// The batch forms of the conversions (UnitMultBatch, UnitDivBatch, ApplyRatioBatch, FromDurationBatch) compute
+/// blocks of BatchBlock unnarrowed results first and narrow each block by NarrowBatch: packssdw for 32 to 16 bit
+/// with SaturateOverflow, branch-free clamps for other saturating cases, plain conversions for WrapOverflow.
+/// The multiplication, decade scaling and division before the narrowing stay scalar with the checks of the
+/// policy, and TrapOverflow narrows element by element (a trap leaves the rest of its block unwritten).
+
+namespace LightUnits {
+    namespace detail {
+        template<typename Unit>
+        struct IsSaturating : std::is_same<typename Unit::OverflowPolicy, SaturateOverflow> {
+        };
+
+        /// Raw value pointer of a unit buffer; units are stored as their raw value
+        template<typename Unit>
+        typename Unit::ValueType *RawPointer(Unit *units) {
+            static_assert(sizeof(Unit) == sizeof(typename Unit::ValueType), "Unit has to be stored as its raw value");
+            return reinterpret_cast<typename Unit::ValueType *>(units);
+        }
+
+        template<typename Unit>
+        typename Unit::ValueType const *RawPointer(Unit const *units) {
+            static_assert(sizeof(Unit) == sizeof(typename Unit::ValueType), "Unit has to be stored as its raw value");
+            return reinterpret_cast<typename Unit::ValueType const *>(units);
+        }
+
+        enum class BatchOp {
+            Add, Sub
+        };
+
+        /// Scalar part, also used for the remainder of the vector loops
+        template<BatchOp Op, typename Unit>
+        void AddSubScalar(Unit const *lhs, Unit const *rhs, Unit *out, std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                out[i] = (Op == BatchOp::Add) ? lhs[i] + rhs[i] : lhs[i] - rhs[i];
+            }
+        }
+
+        template<BatchOp Op, typename T>
+        std::size_t AddSubSaturateSimd(T const *, T const *, T *, std::size_t) {
+            return 0;
+        }
+
+#if defined(__SSE2__)
+        inline __m128i LoadRaw(void const *src) {
+            return _mm_loadu_si128(static_cast<__m128i const *>(src));
+        }
+
+        inline void StoreRaw(void *dst, __m128i val) {
+            _mm_storeu_si128(static_cast<__m128i *>(dst), val);
+        }
+
+        template<BatchOp Op>
+        __m128i SaturateInt8(__m128i a, __m128i b) {
+            return (Op == BatchOp::Add) ? _mm_adds_epi8(a, b) : _mm_subs_epi8(a, b);
+        }
+
+        template<BatchOp Op>
+        __m128i SaturateInt16(__m128i a, __m128i b) {
+            return (Op == BatchOp::Add) ? _mm_adds_epi16(a, b) : _mm_subs_epi16(a, b);
+        }
+
+        /// Wrapping result, replaced by INT_MAX or INT_MIN (depending on the sign of a) in lanes which overflowed
+        template<BatchOp Op>
+        __m128i SaturateInt32(__m128i a, __m128i b) {
+            __m128i const result = (Op == BatchOp::Add) ? _mm_add_epi32(a, b) : _mm_sub_epi32(a, b);
+            // Sign bit set if the operands (with b negated for Sub) have equal signs, but the result does not
+            __m128i const overflow = (Op == BatchOp::Add)
+                                     ? _mm_and_si128(_mm_xor_si128(a, result), _mm_xor_si128(b, result))
+                                     : _mm_and_si128(_mm_xor_si128(a, b), _mm_xor_si128(a, result));
+            __m128i const mask = _mm_srai_epi32(overflow, 31);
+            __m128i const limit = _mm_xor_si128(_mm_srai_epi32(a, 31), _mm_set1_epi32(0x7FFFFFFF));
+            return _mm_or_si128(_mm_and_si128(mask, limit), _mm_andnot_si128(mask, result));
+        }
+
+        template<BatchOp Op>
+        std::size_t AddSubSaturateSimd(std::int8_t const *lhs, std::int8_t const *rhs, std::int8_t *out,
+                                       std::size_t size) {
+            std::size_t i = 0;
+            for (; i + 16 <= size; i += 16) {
+                StoreRaw(out + i, SaturateInt8<Op>(LoadRaw(lhs + i), LoadRaw(rhs + i)));
+            }
+            return i;
+        }
+
+        template<BatchOp Op>
+        std::size_t AddSubSaturateSimd(std::int16_t const *lhs, std::int16_t const *rhs, std::int16_t *out,
+                                       std::size_t size) {
+            std::size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                StoreRaw(out + i, SaturateInt16<Op>(LoadRaw(lhs + i), LoadRaw(rhs + i)));
+            }
+            return i;
+        }
+
+        template<BatchOp Op>
+        std::size_t AddSubSaturateSimd(std::int32_t const *lhs, std::int32_t const *rhs, std::int32_t *out,
+                                       std::size_t size) {
+            std::size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                StoreRaw(out + i, SaturateInt32<Op>(LoadRaw(lhs + i), LoadRaw(rhs + i)));
+            }
+            return i;
+        }
+
+        inline std::size_t NarrowSaturateSimd(std::int32_t const *in, std::int16_t *out, std::size_t size) {
+            std::size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                StoreRaw(out + i, _mm_packs_epi32(LoadRaw(in + i), LoadRaw(in + i + 4)));
+            }
+            return i;
+        }
+#endif
+
+        template<typename In, typename Out>
+        std::size_t NarrowSaturateSimd(In const *, Out *, std::size_t) {
+            return 0;
+        }
+
+        /// Elements per block of the batch conversions, kept on the stack between arithmetic and narrowing
+        constexpr std::size_t BatchBlock = 64;
+
+        enum class NarrowMethod {
+            Policy,     ///< OverflowPolicy::Narrow per element
+            Clamp,      ///< Saturation by min / max, without branches
+            FromFloat   ///< OverflowPolicy::FromFloat per element
+        };
+
+        template<typename Policy, typename Source, typename Target>
+        struct NarrowMethodOf : std::integral_constant<NarrowMethod,
+                std::is_floating_point<Source>::value ? NarrowMethod::FromFloat :
+                (std::is_same<Policy, SaturateOverflow>::value &&
+                 (Limits<Source>::min() < Source(0)) == (Limits<Target>::min() < Target(0)) &&
+                 Limits<Source>::digits >= Limits<Target>::digits) ? NarrowMethod::Clamp : NarrowMethod::Policy> {
+        };
+
+        /// Saturation of val into the range of Target, for a Source covering that range
+        template<typename Target, typename Source>
+        Target ClampTo(Source val) {
+            Source const low = static_cast<Source>(Limits<Target>::min());
+            Source const high = static_cast<Source>(Limits<Target>::max());
+            return static_cast<Target>(val < low ? low : (val > high ? high : val));
+        }
+
+        template<typename Policy, typename Source, typename Target>
+        void NarrowScalar(Source const *in, Target *out, std::size_t begin, std::size_t end,
+                          std::integral_constant<NarrowMethod, NarrowMethod::Policy>) {
+            for (std::size_t i = begin; i < end; ++i) {
+                out[i] = Policy::template Narrow<Target>(in[i]);
+            }
+        }
+
+        template<typename Policy, typename Source, typename Target>
+        void NarrowScalar(Source const *in, Target *out, std::size_t begin, std::size_t end,
+                          std::integral_constant<NarrowMethod, NarrowMethod::Clamp>) {
+            for (std::size_t i = begin; i < end; ++i) {
+                out[i] = ClampTo<Target>(in[i]);
+            }
+        }
+
+        template<typename Policy, typename Source, typename Target>
+        void NarrowScalar(Source const *in, Target *out, std::size_t begin, std::size_t end,
+                          std::integral_constant<NarrowMethod, NarrowMethod::FromFloat>) {
+            for (std::size_t i = begin; i < end; ++i) {
+                out[i] = Policy::template FromFloat<Target>(in[i]);
+            }
+        }
+
+        /// @brief out[i] = Policy::Narrow<Target>(in[i]) (Policy::FromFloat for floating point in)
+        ///
+        template<typename Policy, typename Source, typename Target>
+        void NarrowBatch(Source const *in, Target *out, std::size_t count) {
+            std::size_t done = 0;
+            if (std::is_same<Policy, SaturateOverflow>::value) {
+                done = NarrowSaturateSimd(in, out, count);
+            }
+            NarrowScalar<Policy>(in, out, done, count, NarrowMethodOf<Policy, Source, Target>());
+        }
+
+        /// @brief out[i] = Narrow(wide(i)) for i < count, where wide(i) is the unnarrowed raw result of element i
+        ///
+        /// Element i is read by wide(i) before out[i] is written, so the inputs may alias out.
+        ///
+        template<typename Unit, typename WideFn>
+        void NarrowingBatch(Unit *out, std::size_t count, WideFn wide) {
+            using Wide = decltype(wide(std::size_t(0)));
+            Wide block[BatchBlock];
+            for (std::size_t begin = 0; begin < count; begin += BatchBlock) {
+                std::size_t const n = std::min(BatchBlock, count - begin);
+                for (std::size_t i = 0; i < n; ++i) {
+                    block[i] = wide(begin + i);
+                }
+                NarrowBatch<typename Unit::OverflowPolicy>(block, RawPointer(out + begin), n);
+            }
+        }
+
+        template<BatchOp Op, typename LhsElem, typename RhsElem, typename Unit>
+        void AddSubBatch(UnitSpan<LhsElem> lhs, UnitSpan<RhsElem> rhs, UnitSpan<Unit> out) {
+            static_assert(std::is_same<typename std::remove_const<LhsElem>::type, Unit>::value &&
+                          std::is_same<typename std::remove_const<RhsElem>::type, Unit>::value,
+                          "Operands and result have to be of the same unit");
+            assert(lhs.size() == rhs.size() && lhs.size() == out.size());
+
+            std::size_t done = 0;
+            if (IsSaturating<Unit>::value) {
+                done = AddSubSaturateSimd<Op>(RawPointer(lhs.data()), RawPointer(rhs.data()), RawPointer(out.data()),
+                                              out.size());
+            }
+            AddSubScalar<Op>(lhs.data(), rhs.data(), out.data(), done, out.size());
+        }
+    }
+
+    /// @brief Element-wise addition: out[i] = lhs[i] + rhs[i]
+    ///
+    /// All spans are expected to have the same size. out may alias lhs or rhs.
+    ///
+    template<typename LhsElem, typename RhsElem, typename Unit>
+    void AddBatch(UnitSpan<LhsElem> lhs, UnitSpan<RhsElem> rhs, UnitSpan<Unit> out) {
+        detail::AddSubBatch<detail::BatchOp::Add>(lhs, rhs, out);
+    }
+
+    /// @brief Element-wise subtraction: out[i] = lhs[i] - rhs[i]
+    ///
+    /// \sa AddBatch
+    ///
+    template<typename LhsElem, typename RhsElem, typename Unit>
+    void SubBatch(UnitSpan<LhsElem> lhs, UnitSpan<RhsElem> rhs, UnitSpan<Unit> out) {
+        detail::AddSubBatch<detail::BatchOp::Sub>(lhs, rhs, out);
+    }
+
+    /// @brief Element-wise conversion into a unit of the same kind with different representation
+    ///
+    /// Example: Volt with 32 bit values in mV into a 16 bit Volt for storage or transmission.
+    /// The value is converted into the BasePrefix of Out and narrowed according to the OverflowPolicy of Out.
+    ///
+    template<typename InElem, typename Out>
+    void ConvertBatch(UnitSpan<InElem> in, UnitSpan<Out> out) {
+        using In = typename std::remove_const<InElem>::type;
+        using Wide = typename std::common_type<typename In::ValueType, typename Out::ValueType>::type;
+        using Policy = typename Out::OverflowPolicy;
+        assert(in.size() == out.size());
+
+        std::size_t done = 0;
+        if (detail::IsSaturating<Out>::value && In::BasePrefix == Out::BasePrefix) {
+            done = detail::NarrowSaturateSimd(detail::RawPointer(in.data()), detail::RawPointer(out.data()),
+                                              out.size());
+        }
+        for (std::size_t i = done; i < out.size(); ++i) {
+            auto const scaled = Policy::template Scale<detail::DecadesDiff(In::BasePrefix, Out::BasePrefix)>(
+                    static_cast<Wide>(in[i].template To<In::BasePrefix>()));
+            out[i] = Out::template From<Out::BasePrefix>(Policy::template Narrow<typename Out::ValueType>(scaled));
+        }
+    }
+}
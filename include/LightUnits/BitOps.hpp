@@ -0,0 +1,83 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace LightUnits {
+    namespace detail {
+        /// @brief Number of leading zero bits of a 64 bit value
+        ///
+        /// Returns 64 for x == 0. Maps to a single instruction (lzcnt/bsr, clz) on GCC and Clang.
+        ///
+        inline int CountLeadingZeros(std::uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+            return x == 0 ? 64 : __builtin_clzll(x);
+#else
+            int count = 0;
+            for (std::uint64_t bit = std::uint64_t(1) << 63; bit != 0 && (x & bit) == 0; bit >>= 1) {
+                ++count;
+            }
+            return count;
+#endif
+        }
+
+        /// @brief Number of trailing zero bits of a 64 bit value
+        ///
+        /// Returns 64 for x == 0. \sa CountLeadingZeros
+        ///
+        inline int CountTrailingZeros(std::uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+            return x == 0 ? 64 : __builtin_ctzll(x);
+#else
+            int count = 0;
+            for (; count < 64 && (x & 1u) == 0; x >>= 1) {
+                ++count;
+            }
+            return count;
+#endif
+        }
+
+        /// @brief Magnitude of a signed value as unsigned type of the same size
+        ///
+        /// Well-defined for std::numeric_limits<T>::min() as well.
+        ///
+        template<typename T>
+        constexpr typename std::make_unsigned<T>::type UnsignedAbs(T val) {
+            using U = typename std::make_unsigned<T>::type;
+            return val < 0 ? static_cast<U>(U(0) - static_cast<U>(val)) : static_cast<U>(val);
+        }
+
+        /// @brief Maps a signed value onto an unsigned key with the same ordering by flipping the sign bit
+        ///
+        /// Example for 8 bit: -128 -> 0x00, -1 -> 0x7F, 0 -> 0x80, 127 -> 0xFF
+        ///
+        template<typename T>
+        constexpr typename std::make_unsigned<T>::type OrderedKey(T val) {
+            using U = typename std::make_unsigned<T>::type;
+            return static_cast<U>(static_cast<U>(val) ^ (U(1) << (std::numeric_limits<U>::digits - 1)));
+        }
+
+        /// Inverse of OrderedKey
+        template<typename T>
+        constexpr T FromOrderedKey(typename std::make_unsigned<T>::type key) {
+            using U = typename std::make_unsigned<T>::type;
+            return static_cast<T>(static_cast<U>(key ^ (U(1) << (std::numeric_limits<U>::digits - 1))));
+        }
+    }
+}
@@ -0,0 +1,205 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "BaseUnit.hpp"
+#include "BatchArithmetic.hpp"
+#include "Instrumentation.hpp"
+#include "MultiplyWithExponent.hpp"
+#include "Prefix.hpp"
+#include "TypeTags.hpp"
+#include "UnitArray.hpp"
+#include "UnitSpan.hpp"
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ratio>
+#include <type_traits>
+
+/// Conversions between Second_t units and std::chrono durations
+///
+/// The std::ratio of the duration is combined with the BasePrefix of the unit at compile time.
+/// For all decimal periods (std::nano ... std::kilo) this leaves a single multiplication or division by a
+/// power of ten, or nothing at all if period and BasePrefix match. Other periods (e.g. std::chrono::minutes)
+/// cost at most one multiplication followed by one division. Fractions are truncated towards zero.
+/// Both directions follow the OverflowPolicy of the unit, for the multiplication as well as for the narrowing
+/// into the target representation. Floating point durations are scaled in floating point and then truncated
+/// through OverflowPolicy::FromFloat.
+
+namespace LightUnits {
+    namespace detail {
+        template<int Exponent, bool = (Exponent >= 0)>
+        struct ExponentToPeriod {
+            using type = std::ratio<ExponentToMultiplier<Exponent>::value>;
+        };
+
+        template<int Exponent>
+        struct ExponentToPeriod<Exponent, false> {
+            using type = std::ratio<1, ExponentToMultiplier<-Exponent>::value>;
+        };
+
+        /// std::ratio corresponding to a Prefix, e.g. std::milli for Prefix::Milli
+        template<Prefix P>
+        using PrefixPeriod = typename ExponentToPeriod<static_cast<int>(P)>::type;
+
+        /// val * Num in floating point, no overflow handling needed
+        template<typename Policy, std::intmax_t Num, typename T>
+        constexpr T MultiplyByNum(T val, std::true_type /*floating*/) {
+            return (Num == 1) ? val : val * static_cast<T>(Num);
+        }
+
+        /// val * Num with overflow handled by Policy
+        template<typename Policy, std::intmax_t Num, typename T>
+        constexpr T MultiplyByNum(T val, std::false_type /*floating*/) {
+            static_assert(Num <= Limits<T>::max(), "Period ratio exceeds the representation of the duration or unit");
+            return (Num == 1) ? val : Policy::Mul(val, static_cast<T>(Num));
+        }
+
+        /// val * Num / Den; for ratios with Num != 1 and Den != 1 an overflow of the product is handled before
+        /// the division, i.e. a saturated product is divided as well
+        template<typename Policy, std::intmax_t Num, std::intmax_t Den, typename T>
+        constexpr T ScaleByRatio(T val) {
+            return (Den == 1) ? MultiplyByNum<Policy, Num>(val, std::is_floating_point<T>())
+                              : static_cast<T>(MultiplyByNum<Policy, Num>(val, std::is_floating_point<T>()) / Den);
+        }
+
+        /// Narrowing into an integral Target follows Policy, floating point targets take the value as is
+        template<typename Policy, typename Target, typename Source>
+        constexpr Target NarrowTo(Source val, std::false_type /*floating*/) {
+            return Policy::template Narrow<Target>(val);
+        }
+
+        template<typename Policy, typename Target, typename Source>
+        constexpr Target NarrowTo(Source val, std::true_type /*floating*/) {
+            return static_cast<Target>(val);
+        }
+
+        /// Integral values are narrowed according to Policy, floating point values truncated by Policy::FromFloat
+        template<typename Policy, typename Target, typename Source>
+        constexpr Target FromWide(Source val, std::false_type /*floating*/) {
+            return Policy::template Narrow<Target>(val);
+        }
+
+        template<typename Policy, typename Target, typename Source>
+        constexpr Target FromWide(Source val, std::true_type /*floating*/) {
+            return Policy::template FromFloat<Target>(val);
+        }
+
+        template<typename Unit>
+        struct IsTimeUnit : std::is_same<typename UnitTag<Unit>::type, Second_t> {
+        };
+    }
+
+    /// std::chrono::duration with the same representation as the unit, e.g. duration<int, std::micro>
+    template<typename Unit>
+    using NativeDuration = std::chrono::duration<typename Unit::ValueType, detail::PrefixPeriod<Unit::BasePrefix>>;
+
+    namespace detail {
+        /// FromDuration before the narrowing into Unit::ValueType
+        template<typename Unit, typename Rep, typename Period>
+        constexpr auto FromDurationWide(std::chrono::duration<Rep, Period> const &duration) {
+            static_assert(IsTimeUnit<Unit>::value, "Durations can only be converted into units of Second_t");
+
+            using Scale = std::ratio_divide<Period, PrefixPeriod<Unit::BasePrefix>>;
+            using Wide = typename std::common_type<Rep, typename Unit::ValueType>::type;
+
+            auto const raw = ScaleByRatio<typename Unit::OverflowPolicy, Scale::num, Scale::den>(
+                    static_cast<Wide>(duration.count()));
+
+            LIGHTUNITS_INSTRUMENT(std::is_floating_point<Wide>::value
+                                  ? instrumentation::detail::CheckFloat<Unit, typename Unit::ValueType>(
+                                          instrumentation::Operation::From, raw)
+                                  : instrumentation::detail::CheckNarrow<Unit, typename Unit::ValueType>(
+                                          instrumentation::Operation::From, raw));
+
+            return raw;
+        }
+    }
+
+    /// @brief Converts a std::chrono::duration into a time unit
+    ///
+    /// Example: Second with BasePrefix Micro from std::chrono::nanoseconds(1500) yields 1 us (one division by 1000)
+    ///
+    template<typename Unit, typename Rep, typename Period>
+    constexpr Unit FromDuration(std::chrono::duration<Rep, Period> const &duration) {
+        auto const raw = detail::FromDurationWide<Unit>(duration);
+        return Unit::template From<Unit::BasePrefix>(detail::FromWide<typename Unit::OverflowPolicy,
+                typename Unit::ValueType>(raw, std::is_floating_point<decltype(raw)>()));
+    }
+
+    /// @brief Converts a time unit into the given std::chrono::duration
+    ///
+    /// Overflows of the scaling and of the narrowing into an integral Duration::rep follow the unit's OverflowPolicy.
+    ///
+    template<typename Duration, typename Unit>
+    constexpr Duration ToDuration(Unit const &unit) {
+        static_assert(detail::IsTimeUnit<Unit>::value, "Only units of Second_t can be converted into durations");
+
+        using Scale = std::ratio_divide<detail::PrefixPeriod<Unit::BasePrefix>, typename Duration::period>;
+        using Wide = typename std::common_type<typename Duration::rep, typename Unit::ValueType>::type;
+
+        using Policy = typename Unit::OverflowPolicy;
+        using Rep = typename Duration::rep;
+
+        auto const raw = static_cast<Wide>(unit.template To<Unit::BasePrefix>());
+        return Duration(detail::NarrowTo<Policy, Rep>(detail::ScaleByRatio<Policy, Scale::num, Scale::den>(raw),
+                                                      std::is_floating_point<Rep>()));
+    }
+
+    /// @brief Converts a time unit into the duration of identical representation; no arithmetic is involved
+    ///
+    template<typename Unit>
+    constexpr NativeDuration<Unit> ToDuration(Unit const &unit) {
+        return ToDuration<NativeDuration<Unit>>(unit);
+    }
+
+    /// @brief Element-wise FromDuration: out[i] = in[i]
+    ///
+    /// The scaled values are narrowed block-wise by detail::NarrowBatch.
+    ///
+    template<typename Unit, typename DurationElem>
+    void FromDurationBatch(UnitSpan<DurationElem> in, UnitSpan<Unit> out) {
+        assert(in.size() == out.size());
+
+        detail::NarrowingBatch(out.data(), out.size(), [&](std::size_t i) {
+            return detail::FromDurationWide<Unit>(in[i]);
+        });
+    }
+
+    /// @brief Converts time points into time units relative to origin: out[i] = timestamps[i] - origin
+    ///
+    /// Typical use: timestamps taken from std::chrono::steady_clock during a capture, origin being its start.
+    ///
+    template<typename Unit, typename TimePointElem>
+    void FromTimePointBatch(UnitSpan<TimePointElem> timestamps, typename std::remove_const<TimePointElem>::type origin,
+                            UnitSpan<Unit> out) {
+        assert(timestamps.size() == out.size());
+
+        detail::NarrowingBatch(out.data(), out.size(), [&](std::size_t i) {
+            return detail::FromDurationWide<Unit>(timestamps[i] - origin);
+        });
+    }
+
+    /// \sa FromTimePointBatch
+    template<typename Unit, typename TimePointElem>
+    UnitArray<Unit> FromTimePoints(UnitSpan<TimePointElem> timestamps,
+                                   typename std::remove_const<TimePointElem>::type origin) {
+        UnitArray<Unit> result(timestamps.size());
+        FromTimePointBatch(timestamps, origin, result.Span());
+        return result;
+    }
+}
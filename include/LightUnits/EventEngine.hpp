@@ -0,0 +1,337 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "BatchArithmetic.hpp"
+#include "BitOps.hpp"
+#include "UnitSpan.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// Threshold and slew-rate event detection on unit streams
+///
+/// Detection runs in two stages per block of 64 samples:
+/// (1) Compare kernels turn the samples into bitmasks, one bit per sample (SSE2 for 32 bit units).
+/// (2) A state machine walks the bitmasks with bit scans, touching only the positions at which the state of a
+///     limit changes. Debounce counters and hysteresis state are kept across calls.
+/// The result is a list of compact event records rather than one callback per sample.
+
+namespace LightUnits {
+    enum class LimitCondition : std::uint8_t {
+        Above,      ///< value > threshold
+        Below,      ///< value < threshold
+        SlewAbove   ///< |value - previous value| > threshold
+    };
+
+    /// @brief A limit on a stream of Unit, built by Above(), Below() or SlewAbove()
+    ///
+    /// Example: Above(5_A).For(3) fires once the current exceeds 5 A for 3 consecutive samples.
+    ///          Below(200_V).Hysteresis(5_V) fires below 200 V and clears not before the voltage reaches 205 V.
+    ///
+    template<typename Unit>
+    class Limit {
+    public:
+        constexpr Limit(LimitCondition condition, Unit threshold)
+                : m_condition(condition), m_threshold(threshold), m_release(threshold) {
+        }
+
+        /// Number of consecutive samples which have to violate the limit before the event fires
+        constexpr Limit For(unsigned samples) const {
+            Limit limit = *this;
+            limit.m_debounce = samples < 1 ? 1 : samples;
+            return limit;
+        }
+
+        /// Distance to the threshold the value has to return by before the event clears
+        constexpr Limit Hysteresis(Unit band) const {
+            Limit limit = *this;
+            limit.m_release = (m_condition == LimitCondition::Below) ? m_threshold + band : m_threshold - band;
+            return limit;
+        }
+
+        constexpr LimitCondition Condition() const {
+            return m_condition;
+        }
+
+        constexpr Unit Threshold() const {
+            return m_threshold;
+        }
+
+        /// Clears once the value is <= Release() (Above, SlewAbove) or >= Release() (Below)
+        constexpr Unit Release() const {
+            return m_release;
+        }
+
+        constexpr unsigned Debounce() const {
+            return m_debounce;
+        }
+
+    private:
+        LimitCondition m_condition;
+        Unit m_threshold;
+        Unit m_release;
+        unsigned m_debounce = 1;
+    };
+
+    template<typename Unit>
+    constexpr Limit<Unit> Above(Unit threshold) {
+        return Limit<Unit>(LimitCondition::Above, threshold);
+    }
+
+    template<typename Unit>
+    constexpr Limit<Unit> Below(Unit threshold) {
+        return Limit<Unit>(LimitCondition::Below, threshold);
+    }
+
+    /// Limit on the difference between consecutive samples, e.g. SlewAbove(50_mV) for |dV| > 50 mV
+    template<typename Unit>
+    constexpr Limit<Unit> SlewAbove(Unit threshold) {
+        return Limit<Unit>(LimitCondition::SlewAbove, threshold);
+    }
+
+    enum class EventKind : std::uint8_t {
+        Raised,
+        Cleared
+    };
+
+    /// @brief Compact record of a state change of one limit
+    ///
+    /// index counts the samples of the stream since construction (or Reset()) of the engine. value is the sample
+    /// at index; for SlewAbove the difference to the previous sample.
+    ///
+    template<typename Unit>
+    struct UnitEvent {
+        std::uint64_t index;
+        std::uint16_t channel;
+        std::uint8_t limit;
+        EventKind kind;
+        Unit value;
+    };
+
+    namespace detail {
+        constexpr std::size_t EventBlock = 64;
+
+        /// Bit i set if values[i] > threshold (Greater) or values[i] < threshold (!Greater)
+        template<bool Greater, typename T>
+        std::uint64_t CompareMaskScalar(T const *values, std::size_t count, T threshold) {
+            std::uint64_t mask = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                bool const hit = Greater ? (values[i] > threshold) : (values[i] < threshold);
+                mask |= static_cast<std::uint64_t>(hit) << i;
+            }
+            return mask;
+        }
+
+        template<bool Greater, typename T>
+        std::uint64_t CompareMask(T const *values, std::size_t count, T threshold) {
+            return CompareMaskScalar<Greater>(values, count, threshold);
+        }
+
+#if defined(__SSE2__)
+        template<bool Greater>
+        std::uint64_t CompareMask(std::int32_t const *values, std::size_t count, std::int32_t threshold) {
+            __m128i const limit = _mm_set1_epi32(threshold);
+            std::uint64_t mask = 0;
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m128i const x = LoadRaw(values + i);
+                __m128i const hit = Greater ? _mm_cmpgt_epi32(x, limit) : _mm_cmplt_epi32(x, limit);
+                mask |= static_cast<std::uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(hit))) << i;
+            }
+            // A shift by 64 is undefined, a full block has no scalar tail
+            return (i < count) ? mask | (CompareMaskScalar<Greater>(values + i, count - i, threshold) << i) : mask;
+        }
+#endif
+
+        /// diffs[i] = |values[i] - values[i - 1]| saturated at the limits of T, values[-1] = previous
+        template<typename T>
+        void AbsoluteDifferences(T const *values, std::size_t count, T previous, T *diffs) {
+            for (std::size_t i = 0; i < count; ++i) {
+                T const diff = SaturateOverflow::Sub(values[i], previous);
+                diffs[i] = SaturateOverflow::Negate(diff < 0 ? diff : static_cast<T>(-diff));
+                previous = values[i];
+            }
+        }
+
+        /// Mask with the lowest count bits set
+        inline std::uint64_t LowBits(std::size_t count) {
+            return count >= 64 ? ~std::uint64_t(0) : ((std::uint64_t(1) << count) - 1);
+        }
+    }
+
+    /// @brief Evaluates a set of limits on one channel, i.e. one stream of Unit, block by block
+    ///
+    template<typename Unit>
+    class EventEngine {
+        using ValueType = typename Unit::ValueType;
+
+    public:
+        using Event = UnitEvent<Unit>;
+
+        explicit EventEngine(std::uint16_t channel = 0)
+                : m_channel(channel) {
+        }
+
+        /// Adds a limit and returns its number as used in the event records
+        std::uint8_t Add(Limit<Unit> const &limit) {
+            assert(m_limits.size() < std::numeric_limits<std::uint8_t>::max());
+            m_limits.push_back(State{limit});
+            return static_cast<std::uint8_t>(m_limits.size() - 1);
+        }
+
+        /// True if the event of the given limit has been raised and not cleared yet
+        bool Active(std::uint8_t limit) const {
+            return m_limits[limit].active;
+        }
+
+        /// @brief Processes the next samples of the stream and appends the state changes to events
+        ///
+        template<typename UnitElem>
+        void Process(UnitSpan<UnitElem> samples, std::vector<Event> &events) {
+            static_assert(std::is_same<typename std::remove_const<UnitElem>::type, Unit>::value,
+                          "Samples have to be of the unit of the engine");
+
+            ValueType raw[detail::EventBlock];
+            ValueType diffs[detail::EventBlock];
+
+            for (std::size_t begin = 0; begin < samples.size(); begin += detail::EventBlock) {
+                std::size_t const count = std::min(detail::EventBlock, samples.size() - begin);
+                for (std::size_t i = 0; i < count; ++i) {
+                    raw[i] = samples[begin + i].template To<Unit::BasePrefix>();
+                }
+
+                bool diffsReady = false;
+                for (std::size_t l = 0; l < m_limits.size(); ++l) {
+                    auto &state = m_limits[l];
+                    ValueType const *values = raw;
+                    if (state.limit.Condition() == LimitCondition::SlewAbove) {
+                        if (!diffsReady) {
+                            detail::AbsoluteDifferences(raw, count, m_started ? m_previous : raw[0], diffs);
+                            diffsReady = true;
+                        }
+                        values = diffs;
+                    }
+                    Evaluate(static_cast<std::uint8_t>(l), state, values, count, events);
+                }
+
+                m_started = true;
+                m_previous = raw[count - 1];
+                m_processed += count;
+            }
+        }
+
+        /// Clears all states and restarts the sample index at 0, the limits are kept
+        void Reset() {
+            for (auto &state : m_limits) {
+                state = State{state.limit};
+            }
+            m_processed = 0;
+            m_started = false;
+        }
+
+    private:
+        struct State {
+            Limit<Unit> limit;
+            bool active = false;
+            unsigned run = 0;   ///< Consecutive violating samples so far while inactive
+
+            explicit State(Limit<Unit> const &l)
+                    : limit(l) {
+            }
+        };
+
+        static ValueType Raw(Unit const &unit) {
+            return unit.template To<Unit::BasePrefix>();
+        }
+
+        void Evaluate(std::uint8_t index, State &state, ValueType const *values, std::size_t count,
+                      std::vector<Event> &events) {
+            auto const &limit = state.limit;
+            bool const below = limit.Condition() == LimitCondition::Below;
+
+            std::uint64_t const valid = detail::LowBits(count);
+            std::uint64_t trigger;
+            std::uint64_t release;
+            if (below) {
+                trigger = detail::CompareMask<false>(values, count, Raw(limit.Threshold()));
+                release = ~detail::CompareMask<false>(values, count, Raw(limit.Release())) & valid;
+            } else {
+                trigger = detail::CompareMask<true>(values, count, Raw(limit.Threshold()));
+                release = ~detail::CompareMask<true>(values, count, Raw(limit.Release())) & valid;
+            }
+
+            std::size_t pos = 0;
+            while (pos < count) {
+                if (state.active) {
+                    std::size_t const next = pos + static_cast<unsigned>(detail::CountTrailingZeros(release >> pos));
+                    if (next >= count) {
+                        break;
+                    }
+                    Emit(index, EventKind::Cleared, next, values, events);
+                    state.active = false;
+                    state.run = 0;
+                    pos = next + 1;
+                    continue;
+                }
+
+                // Length of the run of violations starting at pos
+                std::size_t const ones = std::min<std::size_t>(
+                        static_cast<unsigned>(detail::CountTrailingZeros(~(trigger >> pos))), count - pos);
+                if (ones == 0) {
+                    state.run = 0;
+                    std::size_t const next = pos + static_cast<unsigned>(detail::CountTrailingZeros(trigger >> pos));
+                    pos = std::min(next, count);
+                    continue;
+                }
+
+                std::size_t const needed = state.limit.Debounce() - state.run;
+                if (ones >= needed) {
+                    std::size_t const at = pos + needed - 1;
+                    Emit(index, EventKind::Raised, at, values, events);
+                    state.active = true;
+                    pos = at + 1;
+                } else {
+                    state.run += static_cast<unsigned>(ones);
+                    pos += ones;
+                    if (pos < count) {
+                        state.run = 0;
+                    }
+                }
+            }
+        }
+
+        void Emit(std::uint8_t limit, EventKind kind, std::size_t offset, ValueType const *values,
+                  std::vector<Event> &events) const {
+            events.push_back(Event{m_processed + offset, m_channel, limit, kind,
+                                   Unit::template From<Unit::BasePrefix>(values[offset])});
+        }
+
+        std::uint16_t m_channel;
+        std::vector<State> m_limits;
+        std::uint64_t m_processed = 0;
+        ValueType m_previous = 0;
+        bool m_started = false;
+    };
+}
@@ -0,0 +1,338 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "PowerQuality.hpp"
+#include "UnitSpan.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// Fixed-point FFT for the harmonic analysis of unit signals
+///
+/// The transform works in place on complex Q15 values (16 bit real and imaginary part) with block floating point:
+/// before each radix-2 stage, all values are shifted right as far as needed to rule out an overflow in the
+/// butterflies. The shifts are accumulated in a common exponent, so signals of any level keep about 13 to 15
+/// significant bits. Twiddle factors and the bit reversal permutation are constexpr tables, computed by Taylor
+/// series at compile time. With SSE2, four butterflies are computed at once by pmaddwd; the scalar path performs
+/// the identical integer arithmetic and yields bit-identical results.
+
+namespace LightUnits {
+    /// Complex value with 16 bit real and imaginary part, interleaved as expected by the SIMD butterflies
+    struct ComplexQ15 {
+        std::int16_t re;
+        std::int16_t im;
+    };
+
+    namespace detail {
+        constexpr double FftPi = 3.14159265358979323846;
+
+        /// sin(x) and cos(x) for |x| <= pi / 4, exact to double precision
+        constexpr double SinTaylor(double x) {
+            double term = x;
+            double sum = x;
+            for (int n = 1; n < 12; ++n) {
+                term *= -x * x / ((2 * n) * (2 * n + 1));
+                sum += term;
+            }
+            return sum;
+        }
+
+        constexpr double CosTaylor(double x) {
+            double term = 1;
+            double sum = 1;
+            for (int n = 1; n < 12; ++n) {
+                term *= -x * x / ((2 * n - 1) * (2 * n));
+                sum += term;
+            }
+            return sum;
+        }
+
+        /// sin(pi * k / n) and cos(pi * k / n) for 0 <= k < n, reduced to |x| <= pi / 4 by symmetry
+        constexpr double SinOfFraction(std::size_t k, std::size_t n) {
+            return (2 * k > n) ? SinOfFraction(n - k, n)
+                               : (4 * k <= n) ? SinTaylor(FftPi * k / n) : CosTaylor(FftPi * (n - 2 * k) / (2 * n));
+        }
+
+        constexpr double CosOfFraction(std::size_t k, std::size_t n) {
+            return (2 * k > n) ? -CosOfFraction(n - k, n)
+                               : (4 * k <= n) ? CosTaylor(FftPi * k / n) : SinTaylor(FftPi * (n - 2 * k) / (2 * n));
+        }
+
+        /// Rounded to Q15, 1.0 is represented by 32767
+        constexpr std::int16_t ToQ15(double val) {
+            return static_cast<std::int16_t>(val >= 32767.0 / 32768 ? 32767
+                                                                    : val * 32768 + (val >= 0 ? 0.5 : -0.5));
+        }
+
+        /// @brief Twiddle factors of all radix-2 stages and the bit reversal permutation for 2^Log2Size points
+        ///
+        /// The stage with half size h uses the h consecutive entries starting at h - 1: cos and sin of pi * k / h.
+        /// Only the first quadrant of the largest stage is evaluated by Taylor series, everything else is copied by
+        /// symmetry, which keeps the constexpr evaluation within the compiler limits up to 65536 points. The
+        /// values are symmetric: -1.0 is represented by -32767.
+        ///
+        template<unsigned Log2Size>
+        struct FftTables {
+            static constexpr std::size_t Size = std::size_t(1) << Log2Size;
+
+            std::int16_t cos[Size - 1];
+            std::int16_t sin[Size - 1];
+            std::uint16_t bitReverse[Size];
+
+            constexpr FftTables()
+                    : cos(), sin(), bitReverse() {
+                std::size_t const last = Size / 2;
+                std::size_t const top = last - 1;
+                for (std::size_t k = 0; 2 * k <= last; ++k) {
+                    cos[top + k] = ToQ15(CosOfFraction(k, last));
+                    sin[top + k] = ToQ15(SinOfFraction(k, last));
+                }
+                for (std::size_t k = last / 2 + 1; k < last; ++k) {
+                    cos[top + k] = static_cast<std::int16_t>(-cos[top + last - k]);
+                    sin[top + k] = sin[top + last - k];
+                }
+                // Smaller stages take every (last / half)-th twiddle factor of the largest one
+                for (std::size_t half = 1; half < last; half <<= 1) {
+                    for (std::size_t k = 0; k < half; ++k) {
+                        cos[half - 1 + k] = cos[top + k * (last / half)];
+                        sin[half - 1 + k] = sin[top + k * (last / half)];
+                    }
+                }
+                for (std::size_t i = 1; i < Size; ++i) {
+                    bitReverse[i] = static_cast<std::uint16_t>(
+                            (bitReverse[i >> 1] >> 1) | ((i & 1u) << (Log2Size - 1)));
+                }
+            }
+        };
+
+        /// Largest magnitude before a stage, such that a + w * b stays within 16 bits
+        constexpr int FftHeadroomLimit = 10922;
+
+        /// Right shift which brings a maximum magnitude within FftHeadroomLimit (shifted values round down)
+        inline int FftShiftFor(std::int64_t magnitude) {
+            int shift = 0;
+            while (((magnitude + (std::int64_t(1) << shift) - 1) >> shift) > FftHeadroomLimit) {
+                ++shift;
+            }
+            return shift;
+        }
+
+        inline int MaxMagnitude(ComplexQ15 const *data, std::size_t size) {
+            int maximum = 0;
+            for (std::size_t i = 0; i < size; ++i) {
+                int const re = data[i].re < 0 ? -data[i].re : data[i].re;
+                int const im = data[i].im < 0 ? -data[i].im : data[i].im;
+                maximum = re > maximum ? re : maximum;
+                maximum = im > maximum ? im : maximum;
+            }
+            return maximum;
+        }
+
+        inline void ShiftRight(ComplexQ15 *data, std::size_t size, int shift) {
+            for (std::size_t i = 0; i < size; ++i) {
+                data[i].re = static_cast<std::int16_t>(data[i].re >> shift);
+                data[i].im = static_cast<std::int16_t>(data[i].im >> shift);
+            }
+        }
+
+        /// b * w with w = cos - i * sin, products rounded from Q30 to Q15 as by the SIMD path
+        inline void Butterfly(ComplexQ15 &a, ComplexQ15 &b, int cos, int sin) {
+            int const re = (b.re * cos + b.im * sin + (1 << 14)) >> 15;
+            int const im = (b.im * cos - b.re * sin + (1 << 14)) >> 15;
+            b.re = static_cast<std::int16_t>(a.re - re);
+            b.im = static_cast<std::int16_t>(a.im - im);
+            a.re = static_cast<std::int16_t>(a.re + re);
+            a.im = static_cast<std::int16_t>(a.im + im);
+        }
+
+        template<bool Simd>
+        void FftStage(ComplexQ15 *data, std::size_t size, std::size_t half, std::int16_t const *cos,
+                      std::int16_t const *sin) {
+            std::size_t begin = 0;
+#if defined(__SSE2__)
+            if (Simd && half >= 4) {
+                __m128i const round = _mm_set1_epi32(1 << 14);
+                for (std::size_t group = 0; group < size; group += 2 * half) {
+                    for (std::size_t k = 0; k < half; k += 4) {
+                        auto *a = reinterpret_cast<__m128i *>(data + group + k);
+                        auto *b = reinterpret_cast<__m128i *>(data + group + k + half);
+                        __m128i const c = _mm_loadl_epi64(reinterpret_cast<__m128i const *>(cos + k));
+                        __m128i const s = _mm_loadl_epi64(reinterpret_cast<__m128i const *>(sin + k));
+                        __m128i const wRe = _mm_unpacklo_epi16(c, s);
+                        __m128i const wIm = _mm_unpacklo_epi16(_mm_sub_epi16(_mm_setzero_si128(), s), c);
+
+                        __m128i const bv = _mm_loadu_si128(b);
+                        __m128i const re = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(bv, wRe), round), 15);
+                        __m128i const im = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(bv, wIm), round), 15);
+                        __m128i const t = _mm_packs_epi32(_mm_unpacklo_epi32(re, im), _mm_unpackhi_epi32(re, im));
+
+                        __m128i const av = _mm_loadu_si128(a);
+                        _mm_storeu_si128(a, _mm_add_epi16(av, t));
+                        _mm_storeu_si128(b, _mm_sub_epi16(av, t));
+                    }
+                }
+                begin = size;
+            }
+#endif
+            for (std::size_t group = begin; group < size; group += 2 * half) {
+                for (std::size_t k = 0; k < half; ++k) {
+                    Butterfly(data[group + k], data[group + k + half], cos[k], sin[k]);
+                }
+            }
+        }
+
+        template<unsigned Log2Size, bool Simd>
+        int FftTransform(ComplexQ15 *data, FftTables<Log2Size> const &tables) {
+            constexpr std::size_t size = FftTables<Log2Size>::Size;
+
+            for (std::size_t i = 0; i < size; ++i) {
+                std::size_t const j = tables.bitReverse[i];
+                if (i < j) {
+                    ComplexQ15 const swap = data[i];
+                    data[i] = data[j];
+                    data[j] = swap;
+                }
+            }
+
+            int exponent = 0;
+            for (std::size_t half = 1; half < size; half <<= 1) {
+                int const shift = FftShiftFor(MaxMagnitude(data, size));
+                if (shift > 0) {
+                    ShiftRight(data, size, shift);
+                    exponent += shift;
+                }
+                FftStage<Simd>(data, size, half, tables.cos + half - 1, tables.sin + half - 1);
+            }
+            return exponent;
+        }
+    }
+
+    /// @brief In-place forward FFT of 2^Log2Size complex Q15 values
+    ///
+    template<unsigned Log2Size>
+    class FixedFft {
+        static_assert(Log2Size >= 1 && Log2Size <= 16, "Supported sizes are 2 to 65536 points");
+
+    public:
+        static constexpr std::size_t Size = std::size_t(1) << Log2Size;
+
+        /// @brief Transforms data in place
+        ///
+        /// Returns the block exponent e: the spectrum is data * 2^e, i.e. X[k] = sum x[n] * exp(-2 pi i k n / Size).
+        ///
+        static int Transform(ComplexQ15 *data) {
+            return detail::FftTransform<Log2Size, true>(data, Tables);
+        }
+
+        static constexpr detail::FftTables<Log2Size> Tables{};
+    };
+
+    template<unsigned Log2Size>
+    constexpr detail::FftTables<Log2Size> FixedFft<Log2Size>::Tables;
+
+    /// @brief Amplitude spectrum of a real unit signal, e.g. for harmonic distortion analysis
+    ///
+    /// Bin k corresponds to k cycles per 2^Log2Size samples. For exact harmonic amplitudes, the window should
+    /// cover a whole number of fundamental cycles.
+    ///
+    /// All buffers are members, so Analyze() and Amplitudes() need no stack in proportion to the size. Large
+    /// analyzers (6 * 2^Log2Size bytes) should therefore have static storage rather than live on the stack.
+    ///
+    template<typename Unit, unsigned Log2Size>
+    class HarmonicAnalyzer {
+    public:
+        static constexpr std::size_t Size = FixedFft<Log2Size>::Size;
+        static constexpr std::size_t Bins = Size / 2 + 1;
+
+        /// @brief Transforms Size samples of signal
+        ///
+        template<typename Elem>
+        void Analyze(UnitSpan<Elem> signal) {
+            static_assert(std::is_same<typename std::remove_const<Elem>::type, Unit>::value,
+                          "Signal has to be of the unit of the analyzer");
+            assert(signal.size() == Size);
+
+            std::int64_t maximum = 0;
+            for (std::size_t i = 0; i < Size; ++i) {
+                std::int64_t const raw = signal[i].template To<Unit::BasePrefix>();
+                maximum = std::max(maximum, raw < 0 ? -raw : raw);
+            }
+
+            // Normalize into the headroom of the first stage; small signals are shifted left
+            int exponent = detail::FftShiftFor(maximum);
+            while (exponent <= 0 && exponent > -14 && maximum != 0
+                   && (maximum << (1 - exponent)) <= detail::FftHeadroomLimit) {
+                --exponent;
+            }
+            for (std::size_t i = 0; i < Size; ++i) {
+                std::int64_t const raw = signal[i].template To<Unit::BasePrefix>();
+                m_data[i].re = static_cast<std::int16_t>(exponent >= 0 ? raw >> exponent : raw * (1 << -exponent));
+                m_data[i].im = 0;
+            }
+
+            m_exponent = exponent + FixedFft<Log2Size>::Transform(m_data);
+        }
+
+        /// @brief Amplitude of each bin as unit: a sinusoid of amplitude A in bin k yields A
+        ///
+        /// out has to provide Bins elements. Bin 0 is the absolute value of the mean. Not const, as the
+        /// magnitudes are formed in a member scratch buffer; concurrent calls need separate analyzers.
+        ///
+        void Amplitudes(UnitSpan<Unit> out) {
+            assert(out.size() >= Bins);
+
+            // Squares and their roots in place
+            for (std::size_t k = 0; k < Bins; ++k) {
+                std::int32_t const re = m_data[k].re;
+                std::int32_t const im = m_data[k].im;
+                m_magnitudes[k] = static_cast<std::uint32_t>(re * re) + static_cast<std::uint32_t>(im * im);
+            }
+            detail::IntegerSqrtBatch(m_magnitudes, m_magnitudes, Bins);
+
+            for (std::size_t k = 0; k < Bins; ++k) {
+                // Amplitude 2 |X[k]| / Size, |X[k]| / Size for bin 0 and Size / 2
+                int const shift = m_exponent + ((k == 0 || k == Size / 2) ? 0 : 1) - static_cast<int>(Log2Size);
+                std::int64_t const amplitude = shift >= 0
+                                               ? static_cast<std::int64_t>(m_magnitudes[k]) << shift
+                                               : (static_cast<std::int64_t>(m_magnitudes[k]) +
+                                                  (std::int64_t(1) << (-shift - 1))) >> -shift;
+                out[k] = Unit::template From<Unit::BasePrefix>(
+                        Unit::OverflowPolicy::template Narrow<typename Unit::ValueType>(amplitude));
+            }
+        }
+
+        /// Raw spectrum of the last Analyze(), scaled by 2^Exponent()
+        ComplexQ15 const *Spectrum() const {
+            return m_data;
+        }
+
+        int Exponent() const {
+            return m_exponent;
+        }
+
+    private:
+        ComplexQ15 m_data[Size] = {};
+        std::uint32_t m_magnitudes[Bins] = {};   ///< Scratch of Amplitudes()
+        int m_exponent = 0;
+    };
+}
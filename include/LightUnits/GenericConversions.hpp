@@ -15,11 +15,69 @@
 
 #pragma once
 
+#include "BatchArithmetic.hpp"
 #include "MultiplyWithExponent.hpp"
 #include "ValueSystem.hpp"
 #include "Prefix.hpp"
+#include "Instrumentation.hpp"
+#include "UnitSpan.hpp"
+#include <cassert>
+#include <cstddef>
 
 namespace LightUnits {
+    namespace detail {
+        /// Steps (1) and (2) of UnitMult: the raw result in Result::BasePrefix, before the narrowing
+        template<typename ValueSys, typename Result, typename Lhs, typename Rhs>
+        constexpr auto UnitMultWide(Lhs const &lhs, Rhs const &rhs) {
+            using MultValueType = typename MultiplicationResultHelper<ValueSys, typename Lhs::ValueType, typename Rhs::ValueType>::type;
+
+            using Policy = typename Result::OverflowPolicy;
+
+            auto mult_undefinedDimension = Policy::Mul(
+                    static_cast<MultValueType>(lhs.template To<Lhs::BasePrefix>()),
+                    static_cast<MultValueType>(rhs.template To<Rhs::BasePrefix>()));
+
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckScale<
+                    Result, DimensionCorrectionFromMult(Result::BasePrefix, Lhs::BasePrefix, Rhs::BasePrefix)>(
+                    instrumentation::Operation::UnitMult, mult_undefinedDimension));
+
+            auto mult_targetBasePrefix = Policy::template Scale<
+                    DimensionCorrectionFromMult(Result::BasePrefix, Lhs::BasePrefix, Rhs::BasePrefix)>(
+                    mult_undefinedDimension);
+
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckNarrow<Result, typename Result::ValueType>(
+                    instrumentation::Operation::UnitMult, mult_targetBasePrefix));
+
+            return mult_targetBasePrefix;
+        }
+
+        /// UnitDiv before the narrowing into Result::ValueType
+        template<typename ValueSys, typename Result, typename Lhs, typename Rhs>
+        constexpr auto UnitDivWide(Lhs const &lhs, Rhs const &rhs) {
+            auto lhs_raw = lhs.template To<Lhs::BasePrefix>();
+            auto rhs_raw = rhs.template To<Rhs::BasePrefix>();
+
+            using TCorrection = typename LightUnits::LargerType<ValueSys, typename Lhs::ValueType>::type;
+            using Policy = typename Result::OverflowPolicy;
+
+            constexpr int magnitudeCorrection = DimensionCorrectionFromDiv(Result::BasePrefix, Lhs::BasePrefix, Rhs::BasePrefix);
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckScale<Result, magnitudeCorrection>(
+                    instrumentation::Operation::UnitDiv, static_cast<TCorrection>(lhs_raw)));
+
+            auto lhs_raw_corrected = Policy::template Scale<magnitudeCorrection>(static_cast<TCorrection>(lhs_raw));
+
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckRemainder<Result, TCorrection>(
+                    instrumentation::Operation::UnitDiv, lhs_raw_corrected, rhs_raw));
+
+            auto division_raw = Policy::Div(lhs_raw_corrected, static_cast<TCorrection>(rhs_raw));
+
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckNarrow<Result, typename Result::ValueType>(
+                    instrumentation::Operation::UnitDiv, division_raw));
+
+            return division_raw;
+        }
+    }
+
     /// @brief Multiplication of two units yielding a third unit
     ///
     /// Units within the "International Systems of Units" (SI) relate to each other.
@@ -32,19 +90,9 @@ namespace LightUnits {
     ///
     template<typename ValueSys, typename Result, typename Lhs, typename Rhs>
     constexpr Result UnitMult(Lhs const &lhs, Rhs const &rhs) {
-        using MultValueType = typename MultiplicationResultHelper<ValueSys, typename Lhs::ValueType, typename Rhs::ValueType>::type;
-
-        auto mult_undefinedDimension =
-                static_cast<MultValueType>(lhs.template To<Lhs::BasePrefix>())
-                * rhs.template To<Rhs::BasePrefix>();
-
-        auto mult_targetBasePrefix = detail::MultiplyWithExponent<
-                detail::DimensionCorrectionFromMult(Result::BasePrefix, Lhs::BasePrefix, Rhs::BasePrefix)>(
-                mult_undefinedDimension);
-
         return Result::template From<Result::BasePrefix>(
-                static_cast<typename Result::ValueType>(mult_targetBasePrefix)
-        );
+                Result::OverflowPolicy::template Narrow<typename Result::ValueType>(
+                        detail::UnitMultWide<ValueSys, Result>(lhs, rhs)));
     }
 
     /// @brief Division of two units yielding a third unit
@@ -53,17 +101,34 @@ namespace LightUnits {
     ///
     template<typename ValueSys, typename Result, typename Lhs, typename Rhs>
     constexpr Result UnitDiv(Lhs const &lhs, Rhs const &rhs) {
-        auto lhs_raw = lhs.template To<Lhs::BasePrefix>();
-        auto rhs_raw = rhs.template To<Rhs::BasePrefix>();
+        return Result::template From<Result::BasePrefix>(
+                Result::OverflowPolicy::template Narrow<typename Result::ValueType>(
+                        detail::UnitDivWide<ValueSys, Result>(lhs, rhs)));
+    }
 
-        using TCorrection = typename LightUnits::LargerType<ValueSys, typename Lhs::ValueType>::type;
+    /// @brief Element-wise UnitMult: out[i] = lhs[i] * rhs[i]
+    ///
+    /// All spans are expected to have the same size. The results are narrowed block-wise by detail::NarrowBatch.
+    ///
+    template<typename ValueSys, typename Result, typename LhsElem, typename RhsElem>
+    void UnitMultBatch(UnitSpan<LhsElem> lhs, UnitSpan<RhsElem> rhs, UnitSpan<Result> out) {
+        assert(lhs.size() == rhs.size() && lhs.size() == out.size());
 
-        constexpr int magnitudeCorrection = detail::DimensionCorrectionFromDiv(Result::BasePrefix, Lhs::BasePrefix, Rhs::BasePrefix);
-        auto lhs_raw_corrected = detail::MultiplyWithExponent<magnitudeCorrection>(static_cast<TCorrection>(lhs_raw));
+        detail::NarrowingBatch(out.data(), out.size(), [&](std::size_t i) {
+            return detail::UnitMultWide<ValueSys, Result>(lhs[i], rhs[i]);
+        });
+    }
 
-        auto division_raw = lhs_raw_corrected / rhs_raw;
+    /// @brief Element-wise UnitDiv: out[i] = lhs[i] / rhs[i]
+    ///
+    /// \sa UnitMultBatch
+    ///
+    template<typename ValueSys, typename Result, typename LhsElem, typename RhsElem>
+    void UnitDivBatch(UnitSpan<LhsElem> lhs, UnitSpan<RhsElem> rhs, UnitSpan<Result> out) {
+        assert(lhs.size() == rhs.size() && lhs.size() == out.size());
 
-        return Result::template From<Result::BasePrefix>(
-                static_cast<typename Result::ValueType>(division_raw));
+        detail::NarrowingBatch(out.data(), out.size(), [&](std::size_t i) {
+            return detail::UnitDivWide<ValueSys, Result>(lhs[i], rhs[i]);
+        });
     }
 }
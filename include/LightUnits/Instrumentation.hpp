@@ -0,0 +1,442 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+/// Opt-in arithmetic health instrumentation
+///
+/// Define LIGHTUNITS_ENABLE_INSTRUMENTATION (e.g. via the CMake option LIGHTUNITS_INSTRUMENTATION) to count
+/// overflow, narrowing and precision loss events per unit type and per operation.
+/// Without the define, LIGHTUNITS_INSTRUMENT(...) expands to nothing and none of the code below is compiled,
+/// so the generated code is identical to a build without this header.
+///
+/// With the define, every instrumented operation performs a range check. Only if an event is detected, a
+/// thread-local counter is incremented. Counters of all threads are aggregated by TakeSnapshot().
+/// Events detected during constant evaluation make the expression ill-formed, so they are reported at compile time.
+///
+/// Requires RTTI for the unit type names in snapshots.
+
+#ifdef LIGHTUNITS_ENABLE_INSTRUMENTATION
+
+#define LIGHTUNITS_INSTRUMENT(...) __VA_ARGS__
+
+#include "MultiplyWithExponent.hpp"
+#include "OverflowPolicy.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <type_traits>
+#include <vector>
+
+#if defined(__GNUG__)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+#ifndef LIGHTUNITS_INSTRUMENTATION_MAX_UNITS
+/// Number of distinct unit types which are tracked separately. Further types share the last slot.
+#define LIGHTUNITS_INSTRUMENTATION_MAX_UNITS 32
+#endif
+
+namespace LightUnits {
+    namespace instrumentation {
+        enum class Event : int {
+            Overflow = 0,       ///< Result exceeds the range of the unit's ValueType
+            Narrowing,          ///< Conversion into a smaller type changed the value
+            PrecisionLoss,      ///< Non-zero digits were discarded by a division or float conversion
+            Count
+        };
+
+        enum class Operation : int {
+            Add = 0,
+            Subtract,
+            Negate,
+            Multiply,
+            Divide,
+            From,
+            FromFloat,
+            To,
+            UnitMult,
+            UnitDiv,
+            UnitRatio,
+            ApplyRatio,
+            Literal,
+            Count
+        };
+
+        inline char const *ToString(Event event) {
+            switch (event) {
+                case Event::Overflow:
+                    return "Overflow";
+                case Event::Narrowing:
+                    return "Narrowing";
+                case Event::PrecisionLoss:
+                    return "PrecisionLoss";
+                default:
+                    return "?";
+            }
+        }
+
+        inline char const *ToString(Operation op) {
+            switch (op) {
+                case Operation::Add:
+                    return "Add";
+                case Operation::Subtract:
+                    return "Subtract";
+                case Operation::Negate:
+                    return "Negate";
+                case Operation::Multiply:
+                    return "Multiply";
+                case Operation::Divide:
+                    return "Divide";
+                case Operation::From:
+                    return "From";
+                case Operation::FromFloat:
+                    return "FromFloat";
+                case Operation::To:
+                    return "To";
+                case Operation::UnitMult:
+                    return "UnitMult";
+                case Operation::UnitDiv:
+                    return "UnitDiv";
+                case Operation::UnitRatio:
+                    return "UnitRatio";
+                case Operation::ApplyRatio:
+                    return "ApplyRatio";
+                case Operation::Literal:
+                    return "Literal";
+                default:
+                    return "?";
+            }
+        }
+
+        constexpr std::size_t MaxUnitTypes = LIGHTUNITS_INSTRUMENTATION_MAX_UNITS;
+        constexpr std::size_t OperationCount = static_cast<std::size_t>(Operation::Count);
+        constexpr std::size_t EventCount = static_cast<std::size_t>(Event::Count);
+        constexpr std::size_t CounterCount = MaxUnitTypes * OperationCount * EventCount;
+
+        namespace detail {
+            constexpr std::size_t CounterIndex(std::size_t slot, Operation op, Event event) {
+                return (slot * OperationCount + static_cast<std::size_t>(op)) * EventCount
+                       + static_cast<std::size_t>(event);
+            }
+
+            /// @brief Counters owned by exactly one thread
+            ///
+            /// Only the owning thread writes. Relaxed atomics make concurrent reads by TakeSnapshot well-defined
+            /// without a read-modify-write on the hot path.
+            ///
+            struct ThreadCounters {
+                ThreadCounters();
+
+                ~ThreadCounters();
+
+                void Increment(std::size_t index) {
+                    auto &counter = counts[index];
+                    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                }
+
+                std::atomic<std::uint64_t> counts[CounterCount] = {};
+            };
+
+            class Registry {
+            public:
+                static Registry &Instance() {
+                    static Registry registry;
+                    return registry;
+                }
+
+                std::size_t RegisterUnit(std::string name) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (m_names.size() + 1 < MaxUnitTypes) {
+                        m_names.push_back(std::move(name));
+                        return m_names.size() - 1;
+                    }
+                    m_overflowSlotUsed = true;
+                    return MaxUnitTypes - 1;
+                }
+
+                void Attach(ThreadCounters *counters) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_threads.push_back(counters);
+                }
+
+                /// Folds the counters of a terminating thread into the retired totals
+                void Detach(ThreadCounters *counters) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    for (std::size_t i = 0; i < CounterCount; ++i) {
+                        m_retired[i] += counters->counts[i].load(std::memory_order_relaxed);
+                    }
+                    for (auto it = m_threads.begin(); it != m_threads.end(); ++it) {
+                        if (*it == counters) {
+                            m_threads.erase(it);
+                            break;
+                        }
+                    }
+                }
+
+                void Collect(std::vector<std::string> &names, std::vector<std::uint64_t> &totals) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    names = m_names;
+                    if (m_overflowSlotUsed) {
+                        names.resize(MaxUnitTypes - 1);
+                        names.push_back("(other)");
+                    }
+                    totals.assign(m_retired, m_retired + CounterCount);
+                    for (auto const *thread : m_threads) {
+                        for (std::size_t i = 0; i < CounterCount; ++i) {
+                            totals[i] += thread->counts[i].load(std::memory_order_relaxed);
+                        }
+                    }
+                }
+
+                /// Counters of running threads are reset as well. Increments racing with the reset may survive it.
+                void Reset() {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    for (std::size_t i = 0; i < CounterCount; ++i) {
+                        m_retired[i] = 0;
+                    }
+                    for (auto *thread : m_threads) {
+                        for (std::size_t i = 0; i < CounterCount; ++i) {
+                            thread->counts[i].store(0, std::memory_order_relaxed);
+                        }
+                    }
+                }
+
+            private:
+                Registry() = default;
+
+                std::mutex m_mutex;
+                std::vector<std::string> m_names;
+                std::vector<ThreadCounters *> m_threads;
+                std::uint64_t m_retired[CounterCount] = {};
+                bool m_overflowSlotUsed = false;
+            };
+
+            inline ThreadCounters::ThreadCounters() {
+                Registry::Instance().Attach(this);
+            }
+
+            inline ThreadCounters::~ThreadCounters() {
+                Registry::Instance().Detach(this);
+            }
+
+            inline ThreadCounters &LocalCounters() {
+                thread_local ThreadCounters counters;
+                return counters;
+            }
+
+            inline std::string ReadableTypeName(std::type_info const &info) {
+#if defined(__GNUG__)
+                int status = 0;
+                char *demangled = abi::__cxa_demangle(info.name(), nullptr, nullptr, &status);
+                if (status == 0 && demangled != nullptr) {
+                    std::string name(demangled);
+                    std::free(demangled);
+                    return name;
+                }
+#endif
+                return info.name();
+            }
+
+            template<typename Unit>
+            std::size_t UnitSlot() {
+                static std::size_t const slot = Registry::Instance().RegisterUnit(ReadableTypeName(typeid(Unit)));
+                return slot;
+            }
+
+            template<typename Unit>
+            void Record(Operation op, Event event) {
+                LocalCounters().Increment(CounterIndex(UnitSlot<Unit>(), op, event));
+            }
+
+            /// Range checks
+            ///
+            /// Each check is constexpr and only reaches the non-constexpr Record() if an event occurred.
+
+            template<typename Unit, typename T>
+            constexpr void CheckAdd(Operation op, T a, T b) {
+                if (LightUnits::detail::AddOverflows(a, b)) {
+                    Record<Unit>(op, Event::Overflow);
+                }
+            }
+
+            template<typename Unit, typename T>
+            constexpr void CheckSub(Operation op, T a, T b) {
+                if (LightUnits::detail::SubOverflows(a, b)) {
+                    Record<Unit>(op, Event::Overflow);
+                }
+            }
+
+            template<typename Unit, typename T>
+            constexpr void CheckNegate(Operation op, T a) {
+                if (a == LightUnits::detail::Limits<T>::min()) {
+                    Record<Unit>(op, Event::Overflow);
+                }
+            }
+
+            template<typename Unit, typename T>
+            constexpr void CheckMul(Operation op, T a, T b) {
+                if (LightUnits::detail::MulOverflows(a, b)) {
+                    Record<Unit>(op, Event::Overflow);
+                }
+            }
+
+            template<typename Unit, typename T>
+            constexpr void CheckDiv(Operation op, T a, T b) {
+                if (b == -1 && a == LightUnits::detail::Limits<T>::min()) {
+                    Record<Unit>(op, Event::Overflow);
+                } else if (b != 0 && a % b != 0) {
+                    Record<Unit>(op, Event::PrecisionLoss);
+                }
+            }
+
+            /// Checks a scaling by 10^Exponent as performed by detail::MultiplyWithExponent
+            template<typename Unit, int Exponent, typename T>
+            constexpr typename std::enable_if<(Exponent >= 0)>::type CheckScale(Operation op, T val) {
+                using Wide = typename std::common_type<long long, T>::type;
+                constexpr Wide multiplier = LightUnits::detail::ExponentToMultiplier<Exponent>::value;
+                if (static_cast<Wide>(val) > static_cast<Wide>(LightUnits::detail::Limits<T>::max()) / multiplier
+                    || static_cast<Wide>(val) < static_cast<Wide>(LightUnits::detail::Limits<T>::min()) / multiplier) {
+                    Record<Unit>(op, Event::Overflow);
+                }
+            }
+
+            template<typename Unit, int Exponent, typename T>
+            constexpr typename std::enable_if<(Exponent < 0)>::type CheckScale(Operation op, T val) {
+                if (val % LightUnits::detail::ExponentToMultiplier<-Exponent>::value != 0) {
+                    Record<Unit>(op, Event::PrecisionLoss);
+                }
+            }
+
+            template<typename Unit, typename Target, typename Source>
+            constexpr void CheckNarrow(Operation op, Source val) {
+                if (!LightUnits::detail::Fits<Target>(val)) {
+                    Record<Unit>(op, Event::Narrowing);
+                }
+            }
+
+            template<typename Unit, typename T>
+            constexpr void CheckRemainder(Operation op, T dividend, T divisor) {
+                if (divisor != 0 && dividend % divisor != 0) {
+                    Record<Unit>(op, Event::PrecisionLoss);
+                }
+            }
+
+            /// Checks the conversion of a float (or double) into the integral T
+            template<typename Unit, typename T, typename Float>
+            constexpr void CheckFloat(Operation op, Float val) {
+                if (!LightUnits::detail::FloatFits<T>(val)) {
+                    Record<Unit>(op, Event::Overflow);
+                } else if (static_cast<Float>(static_cast<T>(val)) != val) {
+                    Record<Unit>(op, Event::PrecisionLoss);
+                }
+            }
+        }
+
+        /// @brief Aggregated counters of all threads at one point in time
+        ///
+        class Snapshot {
+        public:
+            struct Entry {
+                std::string unit;
+                Operation operation;
+                Event event;
+                std::uint64_t count;
+            };
+
+            Snapshot(std::vector<std::string> units, std::vector<std::uint64_t> counts)
+                    : m_units(std::move(units)), m_counts(std::move(counts)) {
+            }
+
+            template<typename Unit>
+            std::uint64_t Count(Operation op, Event event) const {
+                return m_counts[detail::CounterIndex(detail::UnitSlot<Unit>(), op, event)];
+            }
+
+            template<typename Unit>
+            std::uint64_t Count(Event event) const {
+                std::uint64_t sum = 0;
+                for (std::size_t op = 0; op < OperationCount; ++op) {
+                    sum += Count<Unit>(static_cast<Operation>(op), event);
+                }
+                return sum;
+            }
+
+            std::uint64_t Total(Event event) const {
+                std::uint64_t sum = 0;
+                for (std::size_t slot = 0; slot < MaxUnitTypes; ++slot) {
+                    for (std::size_t op = 0; op < OperationCount; ++op) {
+                        sum += m_counts[detail::CounterIndex(slot, static_cast<Operation>(op), event)];
+                    }
+                }
+                return sum;
+            }
+
+            /// All non-zero counters
+            std::vector<Entry> Entries() const {
+                std::vector<Entry> entries;
+                for (std::size_t slot = 0; slot < m_units.size(); ++slot) {
+                    for (std::size_t op = 0; op < OperationCount; ++op) {
+                        for (std::size_t ev = 0; ev < EventCount; ++ev) {
+                            auto const count = m_counts[detail::CounterIndex(
+                                    slot, static_cast<Operation>(op), static_cast<Event>(ev))];
+                            if (count != 0) {
+                                entries.push_back({m_units[slot], static_cast<Operation>(op),
+                                                   static_cast<Event>(ev), count});
+                            }
+                        }
+                    }
+                }
+                return entries;
+            }
+
+            /// Writes all non-zero counters as CSV with the columns unit;operation;event;count
+            void ExportCsv(std::ostream &os) const {
+                os << "unit;operation;event;count\n";
+                for (auto const &entry : Entries()) {
+                    os << entry.unit << ';' << ToString(entry.operation) << ';'
+                       << ToString(entry.event) << ';' << entry.count << '\n';
+                }
+            }
+
+        private:
+            std::vector<std::string> m_units;
+            std::vector<std::uint64_t> m_counts;
+        };
+
+        inline Snapshot TakeSnapshot() {
+            std::vector<std::string> units;
+            std::vector<std::uint64_t> counts;
+            detail::Registry::Instance().Collect(units, counts);
+            return Snapshot(std::move(units), std::move(counts));
+        }
+
+        inline void Reset() {
+            detail::Registry::Instance().Reset();
+        }
+    }
+}
+
+#else
+
+#define LIGHTUNITS_INSTRUMENT(...)
+
+#endif
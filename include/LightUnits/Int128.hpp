@@ -0,0 +1,223 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+/// 128 bit integers as last element of a ValueSystem
+///
+/// GCC and Clang provide __int128 on 64 bit targets, signalled by LIGHTUNITS_HAS_INT128. With it, int64 units can
+/// be used in UnitMult and UnitDiv:
+///
+///     using ValueSys = LightUnits::ValueSystem<std::int8_t, std::int16_t, int, std::int64_t, LightUnits::Int128>;
+///
+/// The product of two int64 values compiles to a single widening multiply, narrowing back to 64 bits to a
+/// compare of the upper half. Divisions take the 64 bit instructions whenever the operands fit (see Quotient).
+///
+/// In strict ISO mode (e.g. -std=c++14), std::numeric_limits and std::make_unsigned are not specialized for
+/// __int128. The library therefore uses detail::Limits and detail::MakeUnsigned for all value types.
+
+#if defined(__SIZEOF_INT128__)
+#define LIGHTUNITS_HAS_INT128 1
+#endif
+
+namespace LightUnits {
+#if defined(LIGHTUNITS_HAS_INT128)
+    __extension__ typedef __int128 Int128;
+    __extension__ typedef unsigned __int128 UInt128;
+#endif
+
+    namespace detail {
+        /// std::numeric_limits, also for the 128 bit types
+        template<typename T>
+        struct Limits {
+            static constexpr int digits = std::numeric_limits<T>::digits;
+
+            static constexpr T min() {
+                return std::numeric_limits<T>::min();
+            }
+
+            static constexpr T max() {
+                return std::numeric_limits<T>::max();
+            }
+        };
+
+        /// std::make_unsigned, also for the 128 bit types
+        template<typename T>
+        struct MakeUnsigned : std::make_unsigned<T> {
+        };
+
+#if defined(LIGHTUNITS_HAS_INT128)
+        template<>
+        struct Limits<UInt128> {
+            static constexpr int digits = 128;
+
+            static constexpr UInt128 min() {
+                return 0;
+            }
+
+            static constexpr UInt128 max() {
+                return ~UInt128(0);
+            }
+        };
+
+        template<>
+        struct Limits<Int128> {
+            static constexpr int digits = 127;
+
+            static constexpr Int128 min() {
+                return -max() - 1;
+            }
+
+            static constexpr Int128 max() {
+                return static_cast<Int128>(~UInt128(0) >> 1);
+            }
+        };
+
+        template<>
+        struct MakeUnsigned<Int128> {
+            using type = UInt128;
+        };
+
+        template<>
+        struct MakeUnsigned<UInt128> {
+            using type = UInt128;
+        };
+
+        constexpr bool FitsInt64(Int128 val) {
+            return val == static_cast<std::int64_t>(val);
+        }
+#endif
+
+        /// @brief Upper 64 bits of the 128 bit product a * b
+        ///
+        /// A single mul (or mulx with BMI2) on x86-64, umulh on AArch64.
+        ///
+        inline std::uint64_t MulHigh(std::uint64_t a, std::uint64_t b) {
+#if defined(LIGHTUNITS_HAS_INT128)
+            return static_cast<std::uint64_t>((static_cast<UInt128>(a) * b) >> 64);
+#else
+            std::uint64_t const aLo = a & 0xFFFFFFFFu;
+            std::uint64_t const aHi = a >> 32;
+            std::uint64_t const bLo = b & 0xFFFFFFFFu;
+            std::uint64_t const bHi = b >> 32;
+            std::uint64_t const lolo = aLo * bLo;
+            std::uint64_t const hilo = aHi * bLo;
+            std::uint64_t const lohi = aLo * bHi;
+            std::uint64_t const mid = (lolo >> 32) + (hilo & 0xFFFFFFFFu) + (lohi & 0xFFFFFFFFu);
+            return aHi * bHi + (hilo >> 32) + (lohi >> 32) + (mid >> 32);
+#endif
+        }
+
+        /// @brief (high * 2^64 + low) / divisor for high < divisor, i.e. a quotient fitting into 64 bits
+        ///
+        inline std::uint64_t DivideWide(std::uint64_t high, std::uint64_t low, std::uint64_t divisor) {
+            assert(high < divisor);
+#if defined(LIGHTUNITS_HAS_INT128)
+            return static_cast<std::uint64_t>(((static_cast<UInt128>(high) << 64) | low) / divisor);
+#else
+            std::uint64_t quotient = 0;
+            for (int bit = 63; bit >= 0; --bit) {
+                bool const carry = (high >> 63) != 0;
+                high = (high << 1) | ((low >> bit) & 1u);
+                if (carry || high >= divisor) {
+                    high -= divisor;
+                    quotient |= std::uint64_t(1) << bit;
+                }
+            }
+            return quotient;
+#endif
+        }
+
+    }
+
+    /// @brief Signed sum of up to 2^64 values of 64 bits, kept in two 64 bit words
+    ///
+    /// Two's complement 128 bit arithmetic without __int128, e.g. for sums of int64 timestamps or squares.
+    /// Mean() divides the full sum by DivideWide, i.e. a shift-subtract loop where no 128 bit division is available.
+    ///
+    class WideSum {
+    public:
+        template<typename T>
+        void Add(T val) {
+            static_assert(sizeof(T) <= sizeof(std::int64_t) && std::is_signed<T>::value,
+                          "WideSum sums signed values of up to 64 bits");
+            AddWords(static_cast<std::uint64_t>(static_cast<std::int64_t>(val)), val < 0 ? ~std::uint64_t(0) : 0u);
+        }
+
+        void Add(WideSum const &other) {
+            AddWords(other.m_low, other.m_high);
+        }
+
+        /// Sum / count truncated towards zero; the quotient has to fit into 64 bits, as for any mean of Add()ed values
+        template<typename T>
+        T Mean(std::uint64_t count) const {
+            bool const negative = (m_high >> 63) != 0;
+            std::uint64_t const low = negative ? std::uint64_t(0) - m_low : m_low;
+            std::uint64_t const high = negative ? ~m_high + (m_low == 0 ? 1u : 0u) : m_high;
+            std::uint64_t const quotient = detail::DivideWide(high, low, count);
+            return static_cast<T>(static_cast<std::int64_t>(negative ? std::uint64_t(0) - quotient : quotient));
+        }
+
+        void Reset() {
+            m_low = 0;
+            m_high = 0;
+        }
+
+        /// Lower 64 bits of the sum
+        std::uint64_t Low() const {
+            return m_low;
+        }
+
+        /// Upper 64 bits of the sum, including the sign
+        std::int64_t High() const {
+            return static_cast<std::int64_t>(m_high);
+        }
+
+    private:
+        void AddWords(std::uint64_t low, std::uint64_t high) {
+            std::uint64_t const sum = m_low + low;
+            m_high += high + (sum < m_low ? 1u : 0u);
+            m_low = sum;
+        }
+
+        std::uint64_t m_low = 0;
+        std::uint64_t m_high = 0;
+    };
+
+    namespace detail {
+        /// @brief a / b, truncated towards zero
+        ///
+        /// For Int128, operands which fit into 64 bits are divided by the 64 bit instruction instead of the
+        /// 128 bit library routine. b == -1 always takes the 128 bit path, as int64 min / -1 would overflow.
+        ///
+        template<typename T>
+        constexpr T Quotient(T a, T b) {
+            return static_cast<T>(a / b);
+        }
+
+#if defined(LIGHTUNITS_HAS_INT128)
+        constexpr Int128 Quotient(Int128 a, Int128 b) {
+            return (FitsInt64(a) && FitsInt64(b) && b != -1)
+                   ? static_cast<Int128>(static_cast<std::int64_t>(a) / static_cast<std::int64_t>(b))
+                   : a / b;
+        }
+#endif
+    }
+}
@@ -0,0 +1,377 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "Instrumentation.hpp"
+#include "MultiplyWithExponent.hpp"
+#include "Prefix.hpp"
+#include "UnitSpan.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// Conversion between interleaved raw sample frames (e.g. ADC/DMA buffers) and per-channel unit columns
+///
+/// A frame holds one raw sample per channel: V1, I1, V2, I2, ... for two channels. Each channel declares the
+/// prefix its raw samples are denominated in; the conversion into the BasePrefix of its unit happens in the
+/// same pass as the shuffle.
+///
+/// With SSE2, frames of int16_t samples with 2 or 4 channels of 32 bit units are converted 4 frames at a time,
+/// as long as every channel is scaled by 1 or 1000 (i.e. same prefix or one SI step finer). All other layouts
+/// use the scalar loop.
+
+namespace LightUnits {
+    /// @brief Channel of a compile-time layout: raw samples are values of Unit in SourcePrefix
+    ///
+    /// Example: Channel<Volt, Prefix::Milli> for an ADC delivering mV
+    ///
+    template<typename Unit, Prefix SourcePrefix = Unit::BasePrefix>
+    struct Channel {
+        using UnitType = Unit;
+        static constexpr Prefix Source = SourcePrefix;
+        static constexpr int Decades = detail::DecadesDiff(SourcePrefix, Unit::BasePrefix);
+    };
+
+    template<typename Unit, Prefix SourcePrefix>
+    constexpr Prefix Channel<Unit, SourcePrefix>::Source;
+
+    template<typename Unit, Prefix SourcePrefix>
+    constexpr int Channel<Unit, SourcePrefix>::Decades;
+
+    namespace detail {
+        template<bool ... B>
+        struct AllOf : std::is_same<AllOf<B...>, AllOf<(B || true)...>> {
+        };
+
+        /// Raw sample converted into the unit's BasePrefix, see BaseUnit::From
+        template<typename Ch, typename Sample>
+        typename Ch::UnitType SampleToUnit(Sample sample) {
+            using Unit = typename Ch::UnitType;
+            return Unit::template From<Ch::Source>(static_cast<typename Unit::ValueType>(sample));
+        }
+
+        /// Unit converted into a raw sample, limited to the range of Sample (e.g. the DAC code range)
+        template<typename Ch, typename Sample>
+        Sample UnitToSample(typename Ch::UnitType const &unit) {
+            auto const raw = unit.template To<Ch::Source>();
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckNarrow<typename Ch::UnitType, Sample>(
+                    instrumentation::Operation::To, raw));
+            using Wide = typename std::common_type<decltype(raw), Sample>::type;
+            return static_cast<Sample>(std::min<Wide>(std::max<Wide>(raw, std::numeric_limits<Sample>::min()),
+                                                      std::numeric_limits<Sample>::max()));
+        }
+
+        template<typename ... Channels>
+        struct CanDeinterleaveSimd {
+#if defined(__SSE2__)
+            static constexpr bool value = (sizeof...(Channels) == 2 || sizeof...(Channels) == 4) &&
+                    AllOf<(std::is_same<typename Channels::UnitType::ValueType, std::int32_t>::value &&
+                           (Channels::Decades == 0 || Channels::Decades == 3))...>::value;
+#else
+            static constexpr bool value = false;
+#endif
+        };
+
+        template<typename ... Channels>
+        struct CanInterleaveSimd {
+#if defined(__SSE2__)
+            static constexpr bool value = (sizeof...(Channels) == 2 || sizeof...(Channels) == 4) &&
+                    AllOf<(std::is_same<typename Channels::UnitType::ValueType, std::int32_t>::value &&
+                           Channels::Decades == 0)...>::value;
+#else
+            static constexpr bool value = false;
+#endif
+        };
+
+#if defined(__SSE2__)
+        /// Transposes four vectors of four 32 bit lanes
+        inline void Transpose4x4(__m128i &r0, __m128i &r1, __m128i &r2, __m128i &r3) {
+            __m128i const t0 = _mm_unpacklo_epi32(r0, r1);
+            __m128i const t1 = _mm_unpacklo_epi32(r2, r3);
+            __m128i const t2 = _mm_unpackhi_epi32(r0, r1);
+            __m128i const t3 = _mm_unpackhi_epi32(r2, r3);
+            r0 = _mm_unpacklo_epi64(t0, t1);
+            r1 = _mm_unpackhi_epi64(t0, t1);
+            r2 = _mm_unpacklo_epi64(t2, t3);
+            r3 = _mm_unpackhi_epi64(t2, t3);
+        }
+
+        /// @brief 8 int16 samples times per-lane int16 multipliers as two vectors of 4 exact int32 products
+        ///
+        inline void MultiplyWiden(__m128i samples, __m128i multipliers, __m128i &low, __m128i &high) {
+            __m128i const productLow = _mm_mullo_epi16(samples, multipliers);
+            __m128i const productHigh = _mm_mulhi_epi16(samples, multipliers);
+            low = _mm_unpacklo_epi16(productLow, productHigh);
+            high = _mm_unpackhi_epi16(productLow, productHigh);
+        }
+
+        /// Deinterleaves the largest multiple of 4 frames, returns the number of frames processed
+        inline std::size_t DeinterleaveSimd(std::int16_t const *frames, std::size_t frameCount,
+                                            std::int32_t *const *columns, std::int16_t const *multipliers,
+                                            std::integral_constant<std::size_t, 2>) {
+            __m128i const mult = _mm_setr_epi16(multipliers[0], multipliers[1], multipliers[0], multipliers[1],
+                                                multipliers[0], multipliers[1], multipliers[0], multipliers[1]);
+            std::size_t f = 0;
+            for (; f + 4 <= frameCount; f += 4) {
+                __m128i low, high;
+                MultiplyWiden(_mm_loadu_si128(reinterpret_cast<__m128i const *>(frames + 2 * f)), mult, low, high);
+                // [a0 b0 a1 b1] [a2 b2 a3 b3] -> [a0 a1 b0 b1] [a2 a3 b2 b3]
+                low = _mm_shuffle_epi32(low, _MM_SHUFFLE(3, 1, 2, 0));
+                high = _mm_shuffle_epi32(high, _MM_SHUFFLE(3, 1, 2, 0));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(columns[0] + f), _mm_unpacklo_epi64(low, high));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(columns[1] + f), _mm_unpackhi_epi64(low, high));
+            }
+            return f;
+        }
+
+        inline std::size_t DeinterleaveSimd(std::int16_t const *frames, std::size_t frameCount,
+                                            std::int32_t *const *columns, std::int16_t const *multipliers,
+                                            std::integral_constant<std::size_t, 4>) {
+            __m128i const mult = _mm_setr_epi16(multipliers[0], multipliers[1], multipliers[2], multipliers[3],
+                                                multipliers[0], multipliers[1], multipliers[2], multipliers[3]);
+            std::size_t f = 0;
+            for (; f + 4 <= frameCount; f += 4) {
+                __m128i r0, r1, r2, r3;
+                MultiplyWiden(_mm_loadu_si128(reinterpret_cast<__m128i const *>(frames + 4 * f)), mult, r0, r1);
+                MultiplyWiden(_mm_loadu_si128(reinterpret_cast<__m128i const *>(frames + 4 * f + 8)), mult, r2, r3);
+                Transpose4x4(r0, r1, r2, r3);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(columns[0] + f), r0);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(columns[1] + f), r1);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(columns[2] + f), r2);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(columns[3] + f), r3);
+            }
+            return f;
+        }
+
+        /// Interleaves the largest multiple of 4 frames with saturation to int16, returns the frames processed
+        inline std::size_t InterleaveSimd(std::int16_t *frames, std::size_t frameCount,
+                                          std::int32_t const *const *columns, std::integral_constant<std::size_t, 2>) {
+            std::size_t f = 0;
+            for (; f + 4 <= frameCount; f += 4) {
+                __m128i const a = _mm_loadu_si128(reinterpret_cast<__m128i const *>(columns[0] + f));
+                __m128i const b = _mm_loadu_si128(reinterpret_cast<__m128i const *>(columns[1] + f));
+                __m128i const packed = _mm_packs_epi32(_mm_unpacklo_epi32(a, b), _mm_unpackhi_epi32(a, b));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(frames + 2 * f), packed);
+            }
+            return f;
+        }
+
+        inline std::size_t InterleaveSimd(std::int16_t *frames, std::size_t frameCount,
+                                          std::int32_t const *const *columns, std::integral_constant<std::size_t, 4>) {
+            std::size_t f = 0;
+            for (; f + 4 <= frameCount; f += 4) {
+                __m128i r0 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(columns[0] + f));
+                __m128i r1 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(columns[1] + f));
+                __m128i r2 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(columns[2] + f));
+                __m128i r3 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(columns[3] + f));
+                Transpose4x4(r0, r1, r2, r3);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(frames + 4 * f), _mm_packs_epi32(r0, r1));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(frames + 4 * f + 8), _mm_packs_epi32(r2, r3));
+            }
+            return f;
+        }
+#endif
+
+        /// 10^decades for decades in [0, 18]
+        inline std::int64_t PowerOfTen(int decades) {
+            static constexpr std::int64_t powers[] = {
+                    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL, 1000000000LL,
+                    10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL, 100000000000000LL,
+                    1000000000000000LL, 10000000000000000LL, 100000000000000000LL, 1000000000000000000LL};
+            assert(decades >= 0 && decades <= 18);
+            return powers[decades];
+        }
+
+        /// Runtime counterpart of MultiplyWithExponent, truncating towards zero
+        inline std::int64_t ScaleByDecades(std::int64_t val, int decades) {
+            return decades >= 0 ? val * PowerOfTen(decades) : val / PowerOfTen(-decades);
+        }
+    }
+
+    /// @brief Compile-time channel layout of interleaved frames
+    ///
+    /// Example: using PowerFrontEnd = ChannelLayout<Channel<Volt, Prefix::Milli>, Channel<Ampere, Prefix::Milli>>;
+    ///          PowerFrontEnd::Deinterleave(MakeSpan(dmaBuffer), volts.Span(), currents.Span());
+    ///
+    template<typename ... Channels>
+    struct ChannelLayout {
+        static constexpr std::size_t ChannelCount = sizeof...(Channels);
+
+        /// @brief Splits frames into one column per channel and converts each into the unit's BasePrefix
+        ///
+        /// frames holds ChannelCount * n samples, every column n units.
+        ///
+        template<typename SampleElem>
+        static void Deinterleave(UnitSpan<SampleElem> frames, UnitSpan<typename Channels::UnitType> ... columns) {
+            using Sample = typename std::remove_const<SampleElem>::type;
+            assert(frames.size() % ChannelCount == 0);
+            std::size_t const frameCount = frames.size() / ChannelCount;
+            for (std::size_t size : {columns.size()...}) {
+                assert(size == frameCount);
+                (void) size;
+            }
+
+            std::size_t const done = DeinterleaveFast(
+                    std::integral_constant<bool, std::is_same<Sample, std::int16_t>::value &&
+                                                 detail::CanDeinterleaveSimd<Channels...>::value>(),
+                    frames.data(), frameCount, columns.data()...);
+            for (std::size_t f = done; f < frameCount; ++f) {
+                DeinterleaveFrame(std::index_sequence_for<Channels...>(), frames.data() + f * ChannelCount, f,
+                                  columns...);
+            }
+        }
+
+        /// @brief Merges one column per channel into frames, e.g. for output to DACs
+        ///
+        /// Each unit is converted into the channel's source prefix; values outside the range of the sample
+        /// type saturate at its limits.
+        ///
+        template<typename Sample>
+        static void Interleave(UnitSpan<Sample> frames, UnitSpan<typename Channels::UnitType const> ... columns) {
+            assert(frames.size() % ChannelCount == 0);
+            std::size_t const frameCount = frames.size() / ChannelCount;
+            for (std::size_t size : {columns.size()...}) {
+                assert(size == frameCount);
+                (void) size;
+            }
+
+            std::size_t const done = InterleaveFast(
+                    std::integral_constant<bool, std::is_same<Sample, std::int16_t>::value &&
+                                                 detail::CanInterleaveSimd<Channels...>::value>(),
+                    frames.data(), frameCount, columns.data()...);
+            for (std::size_t f = done; f < frameCount; ++f) {
+                InterleaveFrame(std::index_sequence_for<Channels...>(), frames.data() + f * ChannelCount, f,
+                                columns...);
+            }
+        }
+
+    private:
+        template<typename Sample, std::size_t ... I>
+        static void DeinterleaveFrame(std::index_sequence<I...>, Sample const *frame, std::size_t f,
+                                      UnitSpan<typename Channels::UnitType> ... columns) {
+            (void) std::initializer_list<int>{(columns[f] = detail::SampleToUnit<Channels>(frame[I]), 0)...};
+        }
+
+        template<typename Sample, std::size_t ... I>
+        static void InterleaveFrame(std::index_sequence<I...>, Sample *frame, std::size_t f,
+                                    UnitSpan<typename Channels::UnitType const> ... columns) {
+            (void) std::initializer_list<int>{(frame[I] = detail::UnitToSample<Channels, Sample>(columns[f]), 0)...};
+        }
+
+        template<typename Sample>
+        static std::size_t DeinterleaveFast(std::false_type, Sample const *, std::size_t,
+                                            typename Channels::UnitType *...) {
+            return 0;
+        }
+
+        template<typename Sample>
+        static std::size_t InterleaveFast(std::false_type, Sample *, std::size_t,
+                                          typename Channels::UnitType const *...) {
+            return 0;
+        }
+
+#if defined(__SSE2__)
+        // Units of 32 bit representation are stored as their raw value, so columns are accessed as int32 arrays.
+        // Products of int16 samples and multipliers of at most 1000 always fit into int32.
+        static std::size_t DeinterleaveFast(std::true_type, std::int16_t const *frames, std::size_t frameCount,
+                                            typename Channels::UnitType *... columns) {
+            std::int32_t *const raw[] = {reinterpret_cast<std::int32_t *>(columns)...};
+            std::int16_t const multipliers[] = {
+                    static_cast<std::int16_t>(detail::ExponentToMultiplier<Channels::Decades>::value)...};
+            return detail::DeinterleaveSimd(frames, frameCount, raw, multipliers,
+                                            std::integral_constant<std::size_t, ChannelCount>());
+        }
+
+        static std::size_t InterleaveFast(std::true_type, std::int16_t *frames, std::size_t frameCount,
+                                          typename Channels::UnitType const *... columns) {
+            std::int32_t const *const raw[] = {reinterpret_cast<std::int32_t const *>(columns)...};
+            return detail::InterleaveSimd(frames, frameCount, raw, std::integral_constant<std::size_t, ChannelCount>());
+        }
+#endif
+    };
+
+    template<typename ... Channels>
+    constexpr std::size_t ChannelLayout<Channels...>::ChannelCount;
+
+    /// @brief Channel layout known at runtime only, e.g. read from the configuration of the acquisition hardware
+    ///
+    /// Every channel is described by the prefix of its raw samples. The unit of a channel is chosen when it
+    /// is extracted. As each channel is processed on its own, this is a strided gather per channel.
+    ///
+    class RuntimeChannelLayout {
+    public:
+        explicit RuntimeChannelLayout(std::vector<Prefix> sourcePrefixes)
+                : m_sourcePrefixes(std::move(sourcePrefixes)) {
+        }
+
+        std::size_t ChannelCount() const {
+            return m_sourcePrefixes.size();
+        }
+
+        Prefix SourcePrefix(std::size_t channel) const {
+            return m_sourcePrefixes[channel];
+        }
+
+        /// @brief Extracts one channel of frames into out, converting into the BasePrefix of Unit
+        ///
+        template<typename SampleElem, typename Unit>
+        void Deinterleave(UnitSpan<SampleElem> frames, std::size_t channel, UnitSpan<Unit> out) const {
+            std::size_t const count = ChannelCount();
+            assert(channel < count && frames.size() == out.size() * count);
+
+            int const decades = detail::DecadesDiff(m_sourcePrefixes[channel], Unit::BasePrefix);
+            for (std::size_t f = 0; f < out.size(); ++f) {
+                auto const raw = detail::ScaleByDecades(frames[f * count + channel], decades);
+                LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckNarrow<Unit, typename Unit::ValueType>(
+                        instrumentation::Operation::From, raw));
+                out[f] = Unit::template From<Unit::BasePrefix>(
+                        Unit::OverflowPolicy::template Narrow<typename Unit::ValueType>(raw));
+            }
+        }
+
+        /// @brief Writes one channel of frames from column, saturating at the limits of the sample type
+        ///
+        template<typename Sample, typename UnitElem>
+        void Interleave(UnitSpan<Sample> frames, std::size_t channel, UnitSpan<UnitElem> column) const {
+            using Unit = typename std::remove_const<UnitElem>::type;
+            std::size_t const count = ChannelCount();
+            assert(channel < count && frames.size() == column.size() * count);
+
+            int const decades = detail::DecadesDiff(Unit::BasePrefix, m_sourcePrefixes[channel]);
+            for (std::size_t f = 0; f < column.size(); ++f) {
+                auto const raw = detail::ScaleByDecades(column[f].template To<Unit::BasePrefix>(), decades);
+                LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckNarrow<Unit, Sample>(
+                        instrumentation::Operation::To, raw));
+                frames[f * count + channel] = static_cast<Sample>(
+                        std::min<std::int64_t>(std::max<std::int64_t>(raw, std::numeric_limits<Sample>::min()),
+                                               std::numeric_limits<Sample>::max()));
+            }
+        }
+
+    private:
+        std::vector<Prefix> m_sourcePrefixes;
+    };
+}
@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include "Int128.hpp"
+#include <cstdint>
 #include <type_traits>
 
 namespace LightUnits {
@@ -49,5 +51,35 @@ namespace LightUnits {
         MultiplyWithExponent(ValueType val) {
             return val / ExponentToMultiplier<-Exponent>::value;
         }
+
+#if defined(LIGHTUNITS_HAS_INT128)
+        /// @brief u / Divisor for Divisor < 2^32 as long division in three 64 bit steps
+        ///
+        /// Each step divides by a constant, which compiles to a mul-high, unlike the 128 bit library division.
+        ///
+        template<std::uint64_t Divisor>
+        constexpr UInt128 DivideByConstant(UInt128 u) {
+            static_assert(Divisor > 0 && Divisor < (std::uint64_t(1) << 32), "Divisor has to fit into 32 bits");
+            std::uint64_t const high = static_cast<std::uint64_t>(u >> 64);
+            std::uint64_t const low = static_cast<std::uint64_t>(u);
+            std::uint64_t const mid = ((high % Divisor) << 32) | (low >> 32);
+            std::uint64_t const last = ((mid % Divisor) << 32) | (low & 0xFFFFFFFFu);
+            return (static_cast<UInt128>(high / Divisor) << 64) | (static_cast<UInt128>(mid / Divisor) << 32)
+                   | (last / Divisor);
+        }
+
+        /// Values in the 64 bit range take a single 64 bit division by constant
+        template<int Exponent>
+        constexpr typename std::enable_if<(Exponent < 0), Int128>::type
+        MultiplyWithExponent(Int128 val) {
+            return FitsInt64(val)
+                   ? static_cast<Int128>(static_cast<std::int64_t>(val) / ExponentToMultiplier<-Exponent>::value)
+                   : (val < 0)
+                     ? -static_cast<Int128>(DivideByConstant<ExponentToMultiplier<-Exponent>::value>(
+                            UInt128(0) - static_cast<UInt128>(val)))
+                     : static_cast<Int128>(DivideByConstant<ExponentToMultiplier<-Exponent>::value>(
+                            static_cast<UInt128>(val)));
+        }
+#endif
     }
 }
@@ -0,0 +1,314 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "Int128.hpp"
+#include "MultiplyWithExponent.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <type_traits>
+
+/// Overflow policies for the arithmetic of units
+///
+/// The representation struct of a unit selects its policy next to BasePrefix and ValueType:
+///
+///     struct VoltMilliSaturating {
+///         static LightUnits::Prefix const BasePrefix = LightUnits::Prefix::Milli;
+///         typedef std::int16_t ValueType;
+///         typedef LightUnits::SaturateOverflow OverflowPolicy;
+///     };
+///
+/// Without the typedef, WrapOverflow is used. The policy is applied by the operators of BaseUnit, From/To,
+/// the literals and the conversion helpers (UnitMult, UnitDiv, ...).
+
+namespace LightUnits {
+    namespace detail {
+        /// Range checks, all valid for signed T only
+
+        template<typename T>
+        constexpr bool AddOverflows(T a, T b) {
+            return (b > 0) ? (a > Limits<T>::max() - b)
+                           : (a < Limits<T>::min() - b);
+        }
+
+        template<typename T>
+        constexpr bool SubOverflows(T a, T b) {
+            return (b < 0) ? (a > Limits<T>::max() + b)
+                           : (a < Limits<T>::min() + b);
+        }
+
+        template<typename T>
+        constexpr bool MulOverflows(T a, T b) {
+            if (a == 0 || b == 0) {
+                return false;
+            }
+            if (a > 0) {
+                return (b > 0) ? (a > Limits<T>::max() / b)
+                               : (b < Limits<T>::min() / a);
+            }
+            return (b > 0) ? (a < Limits<T>::min() / b)
+                           : (b < Limits<T>::max() / a);
+        }
+
+#if defined(LIGHTUNITS_HAS_INT128)
+        /// Products of two values in the 64 bit range, as formed by UnitMult, cannot overflow
+        constexpr bool MulOverflows(Int128 a, Int128 b) {
+            return !(FitsInt64(a) && FitsInt64(b)) && MulOverflows<Int128>(a, b);
+        }
+#endif
+
+        template<typename T>
+        constexpr bool DivOverflows(T a, T b) {
+            return b == -1 && a == Limits<T>::min();
+        }
+
+        /// True if val * 10^Exponent is not representable by T
+        template<int Exponent, typename T>
+        constexpr typename std::enable_if<(Exponent >= 0), bool>::type ScaleOverflows(T val) {
+            return val > Limits<T>::max() / ExponentToMultiplier<Exponent>::value ||
+                   val < Limits<T>::min() / ExponentToMultiplier<Exponent>::value;
+        }
+
+        template<int Exponent, typename T>
+        constexpr typename std::enable_if<(Exponent < 0), bool>::type ScaleOverflows(T) {
+            return false;
+        }
+
+        /// True if val can be represented by Target without change of value
+        template<typename Target, typename Source>
+        constexpr bool Fits(Source val) {
+            return static_cast<Source>(static_cast<Target>(val)) == val
+                   && ((val < Source(0)) == (static_cast<Target>(val) < Target(0)));
+        }
+
+        template<typename T, typename Float>
+        constexpr bool FloatFits(Float val) {
+            return val >= static_cast<Float>(Limits<T>::min())
+                   && val < -static_cast<Float>(Limits<T>::min());
+        }
+
+        /// Unsigned type for the two's complement arithmetic of T, at least as wide as unsigned int to avoid
+        /// the promotion of small types to (signed) int
+        template<typename T>
+        using WrapType = typename std::common_type<unsigned int, typename MakeUnsigned<T>::type>::type;
+
+        template<typename T>
+        constexpr T Saturated(bool negative) {
+            return negative ? Limits<T>::min() : Limits<T>::max();
+        }
+    }
+
+    /// @brief Two's complement wrap-around, the default
+    ///
+    /// Performed in unsigned arithmetic, so the result is well-defined and the generated code is the same as
+    /// for plain signed arithmetic. Division is the plain built-in division, so min() / -1 is undefined as for
+    /// the built-in types; the other policies handle it.
+    ///
+    struct WrapOverflow {
+        template<typename T>
+        static constexpr T Add(T a, T b) {
+            using U = detail::WrapType<T>;
+            return static_cast<T>(static_cast<U>(a) + static_cast<U>(b));
+        }
+
+        template<typename T>
+        static constexpr T Sub(T a, T b) {
+            using U = detail::WrapType<T>;
+            return static_cast<T>(static_cast<U>(a) - static_cast<U>(b));
+        }
+
+        template<typename T>
+        static constexpr T Negate(T a) {
+            using U = detail::WrapType<T>;
+            return static_cast<T>(U(0) - static_cast<U>(a));
+        }
+
+        template<typename T>
+        static constexpr T Mul(T a, T b) {
+            using U = detail::WrapType<T>;
+            return static_cast<T>(static_cast<U>(a) * static_cast<U>(b));
+        }
+
+        template<typename T>
+        static constexpr T Div(T a, T b) {
+            return detail::Quotient(a, b);
+        }
+
+        /// val * 10^Exponent, see detail::MultiplyWithExponent
+        template<int Exponent, typename T>
+        static constexpr typename std::enable_if<(Exponent >= 0), T>::type Scale(T val) {
+            return Mul<T>(val, static_cast<T>(detail::ExponentToMultiplier<Exponent>::value));
+        }
+
+        template<int Exponent, typename T>
+        static constexpr typename std::enable_if<(Exponent < 0), T>::type Scale(T val) {
+            return detail::MultiplyWithExponent<Exponent>(val);
+        }
+
+        template<typename Target, typename Source>
+        static constexpr Target Narrow(Source val) {
+            return static_cast<Target>(val);
+        }
+
+        /// Values out of range are undefined, as for a plain static_cast
+        template<typename Target, typename Float>
+        static constexpr Target FromFloat(Float val) {
+            return static_cast<Target>(val);
+        }
+    };
+
+    /// @brief Results out of range are clamped to the nearest limit of the type
+    ///
+    /// Floats out of range saturate as well, NaN yields 0.
+    ///
+    struct SaturateOverflow {
+        template<typename T>
+        static constexpr T Add(T a, T b) {
+            return detail::AddOverflows(a, b) ? detail::Saturated<T>(b < 0) : static_cast<T>(a + b);
+        }
+
+        template<typename T>
+        static constexpr T Sub(T a, T b) {
+            return detail::SubOverflows(a, b) ? detail::Saturated<T>(b > 0) : static_cast<T>(a - b);
+        }
+
+        template<typename T>
+        static constexpr T Negate(T a) {
+            return (a == detail::Limits<T>::min()) ? detail::Limits<T>::max() : static_cast<T>(-a);
+        }
+
+        template<typename T>
+        static constexpr T Mul(T a, T b) {
+            return detail::MulOverflows(a, b) ? detail::Saturated<T>((a < 0) != (b < 0)) : static_cast<T>(a * b);
+        }
+
+        template<typename T>
+        static constexpr T Div(T a, T b) {
+            return detail::DivOverflows(a, b) ? detail::Limits<T>::max() : detail::Quotient(a, b);
+        }
+
+        template<int Exponent, typename T>
+        static constexpr T Scale(T val) {
+            return detail::ScaleOverflows<Exponent>(val) ? detail::Saturated<T>(val < 0)
+                                                         : detail::MultiplyWithExponent<Exponent>(val);
+        }
+
+        template<typename Target, typename Source>
+        static constexpr Target Narrow(Source val) {
+            return detail::Fits<Target>(val) ? static_cast<Target>(val) : detail::Saturated<Target>(val < Source(0));
+        }
+
+        template<typename Target, typename Float>
+        static constexpr Target FromFloat(Float val) {
+            return detail::FloatFits<Target>(val) ? static_cast<Target>(val)
+                                                  : (val != val) ? Target(0) : detail::Saturated<Target>(val < 0);
+        }
+    };
+
+    /// Called on overflow by TrapOverflow, with the name of the operation
+    using OverflowTrapHandler = void (*)(char const *operation);
+
+    namespace detail {
+        inline void DefaultOverflowTrap(char const *operation) {
+            std::fprintf(stderr, "LightUnits: overflow in %s\n", operation);
+            std::abort();
+        }
+
+        inline std::atomic<OverflowTrapHandler> &OverflowTrapHandlerStorage() {
+            static std::atomic<OverflowTrapHandler> handler(&DefaultOverflowTrap);
+            return handler;
+        }
+
+        inline void OverflowTrap(char const *operation) {
+            OverflowTrapHandlerStorage().load(std::memory_order_relaxed)(operation);
+        }
+    }
+
+    /// @brief Installs the handler called by TrapOverflow and returns the previous one
+    ///
+    /// The default handler prints the operation to stderr and aborts. A handler may throw, e.g. in tests.
+    ///
+    inline OverflowTrapHandler SetOverflowTrapHandler(OverflowTrapHandler handler) {
+        return detail::OverflowTrapHandlerStorage().exchange(handler);
+    }
+
+    /// @brief Every overflow calls the OverflowTrapHandler
+    ///
+    /// If the handler returns, the wrapped result is used. Overflows during constant evaluation do not compile.
+    ///
+    struct TrapOverflow {
+        template<typename T>
+        static constexpr T Add(T a, T b) {
+            return detail::AddOverflows(a, b) ? (detail::OverflowTrap("Add"), WrapOverflow::Add(a, b))
+                                              : static_cast<T>(a + b);
+        }
+
+        template<typename T>
+        static constexpr T Sub(T a, T b) {
+            return detail::SubOverflows(a, b) ? (detail::OverflowTrap("Subtract"), WrapOverflow::Sub(a, b))
+                                              : static_cast<T>(a - b);
+        }
+
+        template<typename T>
+        static constexpr T Negate(T a) {
+            return (a == detail::Limits<T>::min()) ? (detail::OverflowTrap("Negate"), a) : static_cast<T>(-a);
+        }
+
+        template<typename T>
+        static constexpr T Mul(T a, T b) {
+            return detail::MulOverflows(a, b) ? (detail::OverflowTrap("Multiply"), WrapOverflow::Mul(a, b))
+                                              : static_cast<T>(a * b);
+        }
+
+        template<typename T>
+        static constexpr T Div(T a, T b) {
+            return detail::DivOverflows(a, b) ? (detail::OverflowTrap("Divide"), a) : detail::Quotient(a, b);
+        }
+
+        template<int Exponent, typename T>
+        static constexpr T Scale(T val) {
+            return detail::ScaleOverflows<Exponent>(val)
+                   ? (detail::OverflowTrap("Scale"), WrapOverflow::template Scale<Exponent>(val))
+                   : detail::MultiplyWithExponent<Exponent>(val);
+        }
+
+        template<typename Target, typename Source>
+        static constexpr Target Narrow(Source val) {
+            return detail::Fits<Target>(val) ? static_cast<Target>(val)
+                                             : (detail::OverflowTrap("Narrow"), static_cast<Target>(val));
+        }
+
+        /// Returns 0 if the handler returns for a value out of range
+        template<typename Target, typename Float>
+        static constexpr Target FromFloat(Float val) {
+            return detail::FloatFits<Target>(val) ? static_cast<Target>(val)
+                                                  : (detail::OverflowTrap("FromFloat"), Target(0));
+        }
+    };
+
+    namespace detail {
+        template<typename Rep, typename = void>
+        struct OverflowPolicyOf {
+            using type = WrapOverflow;
+        };
+
+        template<typename Rep>
+        struct OverflowPolicyOf<Rep, typename std::conditional<true, void, typename Rep::OverflowPolicy>::type> {
+            using type = typename Rep::OverflowPolicy;
+        };
+    }
+}
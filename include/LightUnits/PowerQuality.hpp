@@ -0,0 +1,390 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "BatchArithmetic.hpp"
+#include "BitOps.hpp"
+#include "GenericConversions.hpp"
+#include "Int128.hpp"
+#include "MultiplyWithExponent.hpp"
+#include "Prefix.hpp"
+#include "Ratio.hpp"
+#include "UnitSpan.hpp"
+#include "ValueSystem.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// Power quality measures on unit streams in integer arithmetic: true RMS, real and apparent power, power factor
+///
+/// Squares and products are formed in MultiplicationResultHelper<ValueSys, ...>, their sums over a window in the
+/// next larger type of the value system. If there is none, e.g. for 32 bit units on targets without __int128,
+/// 64 bit squares and products are summed in two words by WideWindowSum. Either way no window length can overflow.
+/// Square roots are computed by IntegerSqrt without floating point. Only the IntegerSqrtBatch kernels use the double
+/// precision sqrt of SSE2 where available: exact for 32 bit inputs, followed by an integer correction step for
+/// 64 bit inputs. Their scalar fallback for FPU-less targets is IntegerSqrt. SquareRootBatch and the windows
+/// completed by one RmsMeter::Process call take the 64 bit kernel.
+
+namespace LightUnits {
+    namespace detail {
+        /// @brief floor(sqrt(x)), digit by digit
+        ///
+        /// At most 32 iterations of compare, subtract and shift; no multiplication or division, suitable for
+        /// integer-only targets.
+        ///
+        inline std::uint32_t IntegerSqrt(std::uint64_t x) {
+            if (x == 0) {
+                return 0;
+            }
+            std::uint64_t result = 0;
+            std::uint64_t bit = std::uint64_t(1) << ((63 - CountLeadingZeros(x)) & ~1);
+            while (bit != 0) {
+                if (x >= result + bit) {
+                    x -= result + bit;
+                    result = (result >> 1) + bit;
+                } else {
+                    result >>= 1;
+                }
+                bit >>= 2;
+            }
+            return static_cast<std::uint32_t>(result);
+        }
+
+        /// @brief out[i] = floor(sqrt(in[i]))
+        ///
+        /// The SSE2 path takes the square root in double precision, which is exact for 32 bit inputs: the distance
+        /// of sqrt(k^2 - 1) to k is above 2^-17, far beyond the rounding error of 2^-37. in and out may be the same.
+        ///
+        inline void IntegerSqrtBatch(std::uint32_t const *in, std::uint32_t *out, std::size_t count) {
+            std::size_t i = 0;
+#if defined(__SSE2__)
+            __m128i const bias = _mm_set1_epi32(static_cast<int>(0x80000000u));
+            __m128d const offset = _mm_set1_pd(2147483648.0);
+            for (; i + 4 <= count; i += 4) {
+                // Unsigned to double via the signed conversion of in ^ 2^31
+                __m128i const shifted = _mm_xor_si128(
+                        _mm_loadu_si128(reinterpret_cast<__m128i const *>(in + i)), bias);
+                __m128d const low = _mm_add_pd(_mm_cvtepi32_pd(shifted), offset);
+                __m128d const high = _mm_add_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(shifted, 0x4E)), offset);
+                __m128i const rootLow = _mm_cvttpd_epi32(_mm_sqrt_pd(low));
+                __m128i const rootHigh = _mm_cvttpd_epi32(_mm_sqrt_pd(high));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_unpacklo_epi64(rootLow, rootHigh));
+            }
+#endif
+            for (; i < count; ++i) {
+                out[i] = IntegerSqrt(in[i]);
+            }
+        }
+
+        /// @brief out[i] = floor(sqrt(in[i])) for 64 bit inputs
+        ///
+        /// With SSE2, the double precision estimate is within 2^-20 of the root (the conversion of in[i] rounds
+        /// by at most 2^-53 relative), so one step of +-1 with an exact integer check yields the floor.
+        ///
+        inline void IntegerSqrtBatch(std::uint64_t const *in, std::uint32_t *out, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i) {
+#if defined(__SSE2__)
+                double const estimate = std::sqrt(static_cast<double>(in[i]));
+                std::uint64_t root = (estimate >= 4294967295.0) ? 0xFFFFFFFFu : static_cast<std::uint64_t>(estimate);
+                if (root * root > in[i]) {
+                    --root;
+                } else if (root < 0xFFFFFFFFu && (root + 1) * (root + 1) <= in[i]) {
+                    ++root;
+                }
+                out[i] = static_cast<std::uint32_t>(root);
+#else
+                out[i] = IntegerSqrt(in[i]);
+#endif
+            }
+        }
+
+        /// val * 10^Exponent for unsigned values, saturated at the maximum
+        template<int Exponent>
+        std::uint64_t ScaleSquare(std::uint64_t val) {
+            constexpr std::uint64_t limit = ~std::uint64_t(0) / ExponentToMultiplier<PositivePart(Exponent)>::value;
+            return (Exponent > 0 && val > limit) ? ~std::uint64_t(0) : MultiplyWithExponent<Exponent>(val);
+        }
+
+        /// Product of raw values in the BasePrefix of Lhs and Rhs converted into Result, see UnitMult
+        template<typename Result, typename Lhs, typename Rhs, typename T>
+        Result ProductToUnit(T product) {
+            using Policy = typename Result::OverflowPolicy;
+            auto const scaled = Policy::template Scale<
+                    DimensionCorrectionFromMult(Result::BasePrefix, Lhs::BasePrefix, Rhs::BasePrefix)>(product);
+            return Result::template From<Result::BasePrefix>(
+                    Policy::template Narrow<typename Result::ValueType>(scaled));
+        }
+
+        /// Sum of values over a window in Sum, the next larger type of the value system
+        template<typename Sum>
+        class WindowSum {
+        public:
+            template<typename T>
+            void Add(T val) {
+                m_sum += static_cast<Sum>(val);
+            }
+
+            /// Truncated mean of count values of T, which fits into T
+            template<typename T>
+            T Mean(std::size_t count) const {
+                return static_cast<T>(Quotient(m_sum, static_cast<Sum>(count)));
+            }
+
+            void Reset() {
+                m_sum = 0;
+            }
+
+        private:
+            Sum m_sum = 0;
+        };
+
+        /// Sum of int64 values in two 64 bit words, for value systems without a larger type
+        using WideWindowSum = WideSum;
+
+        /// WindowSum of the next larger type of T if ValueSys has one, WideWindowSum otherwise
+        template<typename ValueSys, typename T,
+                bool = (PositionOf<ValueSys, T>::value + 1 < Count<ValueSys>::value)>
+        struct WindowSumOf {
+            using type = WindowSum<typename LargerType<ValueSys, T>::type>;
+        };
+
+        template<typename ValueSys, typename T>
+        struct WindowSumOf<ValueSys, T, false> {
+            using type = WideWindowSum;
+        };
+    }
+
+    /// @brief Square root of a squared quantity, e.g. the mean square of Volt samples
+    ///
+    /// squared is the raw value in SourcePrefix^2 (mV^2 for SourcePrefix = Milli). It is rescaled to
+    /// Result::BasePrefix^2 before the root is taken: 4000000 mV^2 yields 2000 mV or 2 V.
+    /// Results out of range of Result are narrowed according to its OverflowPolicy.
+    ///
+    template<typename Result, Prefix SourcePrefix>
+    Result SquareRoot(std::uint64_t squared) {
+        constexpr int decades = detail::DecadesDiff(SourcePrefix, Result::BasePrefix);
+        std::uint32_t const root = detail::IntegerSqrt(detail::ScaleSquare<2 * decades>(squared));
+        return Result::template From<Result::BasePrefix>(
+                Result::OverflowPolicy::template Narrow<typename Result::ValueType>(static_cast<std::int64_t>(root)));
+    }
+
+    /// @brief Element-wise SquareRoot: out[i] = sqrt(squared[i])
+    ///
+    /// The roots are taken by the 64 bit IntegerSqrtBatch and narrowed block-wise by detail::NarrowBatch;
+    /// the results are identical to SquareRoot.
+    ///
+    template<typename Result, Prefix SourcePrefix, typename SquaredElem>
+    void SquareRootBatch(UnitSpan<SquaredElem> squared, UnitSpan<Result> out) {
+        static_assert(std::is_same<typename std::remove_const<SquaredElem>::type, std::uint64_t>::value,
+                      "Squares are expected as std::uint64_t");
+        assert(squared.size() == out.size());
+
+        constexpr int decades = detail::DecadesDiff(SourcePrefix, Result::BasePrefix);
+        std::uint64_t scaled[detail::BatchBlock];
+        std::uint32_t roots[detail::BatchBlock];
+        for (std::size_t begin = 0; begin < out.size(); begin += detail::BatchBlock) {
+            std::size_t const n = std::min(detail::BatchBlock, out.size() - begin);
+            for (std::size_t i = 0; i < n; ++i) {
+                scaled[i] = detail::ScaleSquare<2 * decades>(squared[begin + i]);
+            }
+            detail::IntegerSqrtBatch(scaled, roots, n);
+            detail::NarrowBatch<typename Result::OverflowPolicy>(roots, detail::RawPointer(out.data() + begin), n);
+        }
+    }
+
+    /// @brief True RMS over consecutive windows of a fixed number of samples, e.g. one mains cycle
+    ///
+    /// Windows continue across calls of Process.
+    ///
+    template<typename ValueSys, typename Unit>
+    class RmsMeter {
+    public:
+        using SquareType = typename MultiplicationResultHelper<ValueSys, typename Unit::ValueType,
+                typename Unit::ValueType>::type;
+        using SumType = typename detail::WindowSumOf<ValueSys, SquareType>::type;
+
+        explicit RmsMeter(std::size_t window)
+                : m_window(window) {
+            assert(window > 0);
+        }
+
+        /// Number of outputs produced by the next inputCount input samples
+        std::size_t OutputsFor(std::size_t inputCount) const {
+            return (m_count + inputCount) / m_window;
+        }
+
+        /// @brief Consumes in and writes the RMS of each completed window to out
+        ///
+        /// out has to provide OutputsFor(in.size()) elements. Returns the number of outputs written.
+        ///
+        template<typename InElem>
+        std::size_t Process(UnitSpan<InElem> in, UnitSpan<Unit> out) {
+            assert(out.size() >= OutputsFor(in.size()));
+
+            // Mean squares of the completed windows, rooted block-wise
+            std::uint64_t means[detail::BatchBlock];
+            std::size_t pending = 0;
+            std::size_t written = 0;
+            for (std::size_t i = 0; i < in.size();) {
+                std::size_t const take = std::min(m_window - m_count, in.size() - i);
+                for (std::size_t end = i + take; i < end; ++i) {
+                    SquareType const raw = in[i].template To<Unit::BasePrefix>();
+                    m_sum.Add(raw * raw);
+                }
+                m_count += take;
+                if (m_count == m_window) {
+                    means[pending++] = Complete();
+                    if (pending == detail::BatchBlock) {
+                        written += Roots(means, pending, out.subspan(written, pending));
+                        pending = 0;
+                    }
+                }
+            }
+            return written + Roots(means, pending, out.subspan(written, pending));
+        }
+
+        void Reset() {
+            m_sum.Reset();
+            m_count = 0;
+        }
+
+    private:
+        /// Mean square of the completed window
+        std::uint64_t Complete() {
+            auto const mean = static_cast<std::uint64_t>(m_sum.template Mean<SquareType>(m_window));
+            Reset();
+            return mean;
+        }
+
+        static std::size_t Roots(std::uint64_t const *means, std::size_t count, UnitSpan<Unit> out) {
+            SquareRootBatch<Unit, Unit::BasePrefix>(MakeSpan(means, count), out);
+            return count;
+        }
+
+        std::size_t m_window;
+        std::size_t m_count = 0;
+        SumType m_sum;
+    };
+
+    /// @brief Results of PowerAnalyzer for one window
+    ///
+    /// The power factor is real / apparent power as fixed-point Ratio, negative for reverse power flow.
+    ///
+    template<typename Voltage, typename Current, typename Power, typename PowerFactor>
+    struct PowerReading {
+        Voltage voltageRms;
+        Current currentRms;
+        Power realPower;
+        Power apparentPower;
+        PowerFactor powerFactor;
+    };
+
+    /// @brief True RMS, real power, apparent power and power factor over consecutive windows of
+    /// simultaneously sampled voltage and current
+    ///
+    /// Real power is the mean of the instantaneous products, converted like UnitMult. Apparent power is
+    /// UnitMult of the two RMS values. As both RMS values are truncated, the power factor of a purely
+    /// resistive load may slightly exceed 1 and is therefore limited to [-1, 1]. The RMS values are rooted per
+    /// window, as each reading combines them with the products of the same window; use RmsMeter directly to
+    /// root many windows block-wise.
+    ///
+    template<typename ValueSys, typename Voltage, typename Current, typename Power,
+            typename PowerFactor = Ratio<int, 16>>
+    class PowerAnalyzer {
+    public:
+        using Reading = PowerReading<Voltage, Current, Power, PowerFactor>;
+        using ProductType = typename MultiplicationResultHelper<ValueSys, typename Voltage::ValueType,
+                typename Current::ValueType>::type;
+        using ProductSumType = typename detail::WindowSumOf<ValueSys, ProductType>::type;
+
+        explicit PowerAnalyzer(std::size_t window)
+                : m_window(window), m_voltage(window), m_current(window) {
+        }
+
+        /// @brief Consumes voltage and current and appends one reading per completed window
+        ///
+        /// Both spans are expected to have the same size. Returns the number of readings appended.
+        ///
+        template<typename VoltageElem, typename CurrentElem>
+        std::size_t Process(UnitSpan<VoltageElem> voltage, UnitSpan<CurrentElem> current,
+                            std::vector<Reading> &readings) {
+            assert(voltage.size() == current.size());
+
+            std::size_t const before = readings.size();
+            for (std::size_t i = 0; i < voltage.size();) {
+                std::size_t const take = std::min(m_window - m_count, voltage.size() - i);
+                for (std::size_t end = i + take; i < end; ++i) {
+                    ProductType const v = voltage[i].template To<Voltage::BasePrefix>();
+                    ProductType const c = current[i].template To<Current::BasePrefix>();
+                    m_productSum.Add(v * c);
+                }
+
+                Voltage voltageRms;
+                Current currentRms;
+                std::size_t const begin = i - take;
+                m_voltage.Process(voltage.subspan(begin, take), UnitSpan<Voltage>(&voltageRms, 1));
+                m_current.Process(current.subspan(begin, take), UnitSpan<Current>(&currentRms, 1));
+
+                m_count += take;
+                if (m_count == m_window) {
+                    readings.push_back(Complete(voltageRms, currentRms));
+                }
+            }
+            return readings.size() - before;
+        }
+
+        void Reset() {
+            m_voltage.Reset();
+            m_current.Reset();
+            m_productSum.Reset();
+            m_count = 0;
+        }
+
+    private:
+        Reading Complete(Voltage voltageRms, Current currentRms) {
+            auto const meanProduct = m_productSum.template Mean<ProductType>(m_window);
+            m_productSum.Reset();
+            m_count = 0;
+
+            Power const real = detail::ProductToUnit<Power, Voltage, Current>(meanProduct);
+            Power const apparent = UnitMult<ValueSys, Power>(voltageRms, currentRms);
+            return Reading{voltageRms, currentRms, real, apparent, PowerFactorOf(real, apparent)};
+        }
+
+        static PowerFactor PowerFactorOf(Power const &real, Power const &apparent) {
+            if (apparent.template To<Power::BasePrefix>() == 0) {
+                return PowerFactor::FromRaw(0);
+            }
+            auto const ratio = UnitRatio<ValueSys, PowerFactor>(real, apparent);
+            return (ratio > PowerFactor::FromInteger(1)) ? PowerFactor::FromInteger(1)
+                   : (ratio < PowerFactor::FromInteger(-1)) ? PowerFactor::FromInteger(-1) : ratio;
+        }
+
+        std::size_t m_window;
+        std::size_t m_count = 0;
+        ProductSumType m_productSum;
+        RmsMeter<ValueSys, Voltage> m_voltage;
+        RmsMeter<ValueSys, Current> m_current;
+    };
+}
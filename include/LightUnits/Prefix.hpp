@@ -19,6 +19,7 @@ namespace LightUnits {
     /// @brief Based on SI prefixes
     ///
     enum class Prefix : int {
+        Nano = -9,
         Micro = -6,
         Milli = -3,
         One = 0,
@@ -0,0 +1,161 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "BitOps.hpp"
+#include "GenericConversions.hpp"
+#include "Int128.hpp"
+#include "UnitSpan.hpp"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/// Division by a divisor which is constant at runtime, e.g. a fixed shunt resistance
+///
+///     PreparedDivisor<Ohm> const shunt(100_mOhm);
+///     UnitDivBatch<IntegralValueSystem, Ampere>(voltages, shunt, currents);
+///
+/// The constructor computes a multiply-and-shift reciprocal once (Granlund, Montgomery: "Division by Invariant
+/// Integers using Multiplication", 1994). Each division then costs a mul-high, two shifts and the sign fix-up,
+/// the decade correction of UnitDiv a multiplication or a division by a constant. No division instructions are
+/// executed per element. Results are identical to UnitDiv, including the OverflowPolicy of the result.
+
+namespace LightUnits {
+    namespace detail {
+        /// @brief Division of unsigned 64 bit values by an invariant divisor
+        ///
+        /// With l = ceil(log2(d)) and m = floor(2^64 * (2^l - d) / d) + 1, n / d equals
+        /// (t + ((n - t) >> min(l, 1))) >> max(l - 1, 0) with t = MulHigh(m, n) for all n, d >= 1.
+        ///
+        class UnsignedReciprocal {
+        public:
+            explicit UnsignedReciprocal(std::uint64_t divisor) {
+                assert(divisor != 0);
+                int const log = 64 - CountLeadingZeros(divisor - 1);
+                std::uint64_t const excess = (log == 64) ? std::uint64_t(0) - divisor
+                                                         : (std::uint64_t(1) << log) - divisor;
+                m_multiplier = DivideWide(excess, 0, divisor) + 1;
+                m_shift1 = static_cast<unsigned char>(log < 1 ? log : 1);
+                m_shift2 = static_cast<unsigned char>(log > 1 ? log - 1 : 0);
+            }
+
+            std::uint64_t Divide(std::uint64_t n) const {
+                std::uint64_t const t = MulHigh(m_multiplier, n);
+                return (t + ((n - t) >> m_shift1)) >> m_shift2;
+            }
+
+        private:
+            std::uint64_t m_multiplier;
+            unsigned char m_shift1;
+            unsigned char m_shift2;
+        };
+    }
+
+    /// @brief Divisor unit prepared for repeated UnitDiv
+    ///
+    /// Dividends of up to 64 bits are supported, i.e. LargerType<ValueSys, Lhs::ValueType> must not exceed 64 bits.
+    ///
+    template<typename Unit>
+    class PreparedDivisor {
+    public:
+        explicit PreparedDivisor(Unit const &divisor)
+                : m_divisor(divisor),
+                  m_raw(divisor.template To<Unit::BasePrefix>()),
+                  m_reciprocal(detail::UnsignedAbs(static_cast<std::int64_t>(m_raw))) {
+        }
+
+        Unit Divisor() const {
+            return m_divisor;
+        }
+
+        /// Raw value of the divisor in Unit::BasePrefix
+        typename Unit::ValueType Raw() const {
+            return m_raw;
+        }
+
+        /// @brief Truncated quotient dividend / Raw()
+        ///
+        /// Same as the built-in division, except for min() / -1 which is left to the OverflowPolicy
+        /// (see UnitDiv).
+        ///
+        template<typename T>
+        T Divide(T dividend) const {
+            static_assert(sizeof(T) <= sizeof(std::int64_t), "PreparedDivisor supports dividends up to 64 bits");
+            std::int64_t const n = dividend;
+            std::uint64_t const quotient = m_reciprocal.Divide(detail::UnsignedAbs(n));
+            bool const negative = (n < 0) != (m_raw < 0);
+            return static_cast<T>(static_cast<std::int64_t>(negative ? std::uint64_t(0) - quotient : quotient));
+        }
+
+    private:
+        Unit m_divisor;
+        typename Unit::ValueType m_raw;
+        detail::UnsignedReciprocal m_reciprocal;
+    };
+
+    namespace detail {
+        /// UnitDiv by a PreparedDivisor before the narrowing into Result::ValueType
+        template<typename ValueSys, typename Result, typename Lhs, typename Rhs>
+        auto UnitDivWide(Lhs const &lhs, PreparedDivisor<Rhs> const &divisor) {
+            using TCorrection = typename LightUnits::LargerType<ValueSys, typename Lhs::ValueType>::type;
+            using Policy = typename Result::OverflowPolicy;
+
+            auto lhs_raw = lhs.template To<Lhs::BasePrefix>();
+
+            constexpr int magnitudeCorrection = DimensionCorrectionFromDiv(Result::BasePrefix, Lhs::BasePrefix, Rhs::BasePrefix);
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckScale<Result, magnitudeCorrection>(
+                    instrumentation::Operation::UnitDiv, static_cast<TCorrection>(lhs_raw)));
+
+            auto lhs_raw_corrected = Policy::template Scale<magnitudeCorrection>(static_cast<TCorrection>(lhs_raw));
+            auto const rhs_raw = static_cast<TCorrection>(divisor.Raw());
+
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckRemainder<Result, TCorrection>(
+                    instrumentation::Operation::UnitDiv, lhs_raw_corrected, rhs_raw));
+
+            // -1 is the only divisor that can overflow, leave it to the policy
+            auto division_raw = (rhs_raw == -1) ? Policy::Div(lhs_raw_corrected, rhs_raw)
+                                                : divisor.Divide(lhs_raw_corrected);
+
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckNarrow<Result, typename Result::ValueType>(
+                    instrumentation::Operation::UnitDiv, division_raw));
+
+            return division_raw;
+        }
+    }
+
+    /// @brief UnitDiv by a PreparedDivisor, yields the same result as UnitDiv(lhs, divisor.Divisor())
+    ///
+    template<typename ValueSys, typename Result, typename Lhs, typename Rhs>
+    Result UnitDiv(Lhs const &lhs, PreparedDivisor<Rhs> const &divisor) {
+        return Result::template From<Result::BasePrefix>(
+                Result::OverflowPolicy::template Narrow<typename Result::ValueType>(
+                        detail::UnitDivWide<ValueSys, Result>(lhs, divisor)));
+    }
+
+    /// @brief Element-wise UnitDiv by a PreparedDivisor: out[i] = lhs[i] / divisor
+    ///
+    /// \sa UnitDivBatch
+    ///
+    template<typename ValueSys, typename Result, typename LhsElem, typename Rhs>
+    void UnitDivBatch(UnitSpan<LhsElem> lhs, PreparedDivisor<Rhs> const &divisor, UnitSpan<Result> out) {
+        assert(lhs.size() == out.size());
+
+        detail::NarrowingBatch(out.data(), out.size(), [&](std::size_t i) {
+            return detail::UnitDivWide<ValueSys, Result>(lhs[i], divisor);
+        });
+    }
+}
@@ -0,0 +1,352 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "BaseUnit.hpp"
+#include "BatchArithmetic.hpp"
+#include "Instrumentation.hpp"
+#include "Int128.hpp"
+#include "MultiplyWithExponent.hpp"
+#include "Prefix.hpp"
+#include "UnitSpan.hpp"
+#include "ValueSystem.hpp"
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace LightUnits {
+    /// @brief Dimensionless fixed-point number in Q-format
+    ///
+    /// The represented value is Raw() / 2^FractionalBits.
+    /// Example: Ratio<int, 16> stores 0.5 as raw value 32768 and 1.25 as 81920.
+    ///
+    /// A Ratio is the integer-only counterpart of BaseUnit::operator/(BaseUnit), which yields a float.
+    /// It is created from two units by UnitRatio and multiplied back into a unit by ApplyRatio.
+    ///
+    template<typename T_Value, unsigned FractionalBits>
+    class Ratio {
+        static_assert(std::numeric_limits<T_Value>::is_integer, "Ratio requires an integral representation");
+        static_assert(FractionalBits < static_cast<unsigned>(std::numeric_limits<T_Value>::digits),
+                      "Not enough bits left for the integer part");
+
+    public:
+        using ValueType = T_Value;
+
+        Ratio() = default;
+
+        Ratio(Ratio const &) = default;
+
+        /// Raw value corresponding to 1.0
+        static constexpr ValueType OneRaw() {
+            return static_cast<ValueType>(ValueType(1) << FractionalBits);
+        }
+
+        static constexpr unsigned Fractional() {
+            return FractionalBits;
+        }
+
+        static constexpr Ratio FromRaw(ValueType raw) {
+            return Ratio(raw);
+        }
+
+        /// Integers out of range are handled by Policy, by default they wrap around (see OverflowPolicy.hpp)
+        ///
+        template<typename Policy = WrapOverflow>
+        static constexpr Ratio FromInteger(ValueType val) {
+            return Ratio(Policy::Mul(val, OneRaw()));
+        }
+
+        /// Converts the given float value, discarding everything below the resolution of 2^-FractionalBits
+        ///
+        static constexpr Ratio FromFloat(float val) {
+            return Ratio(static_cast<ValueType>(val * OneRaw()));
+        }
+
+        constexpr ValueType Raw() const {
+            return m_value;
+        }
+
+        constexpr float ToFloat() const {
+            return static_cast<float>(m_value) / OneRaw();
+        }
+
+        /// Arithmetic operators
+        inline constexpr Ratio operator-() const {
+            return Ratio(-m_value);
+        }
+
+        inline constexpr Ratio operator+(Ratio const &rhs) const {
+            return Ratio(m_value + rhs.m_value);
+        }
+
+        inline constexpr Ratio operator-(Ratio const &rhs) const {
+            return Ratio(m_value - rhs.m_value);
+        }
+
+        /// Comparision operators
+        friend constexpr bool operator==(Ratio const &lhs, Ratio const &rhs) {
+            return lhs.m_value == rhs.m_value;
+        }
+
+        friend constexpr bool operator!=(Ratio const &lhs, Ratio const &rhs) {
+            return lhs.m_value != rhs.m_value;
+        }
+
+        friend constexpr bool operator<(Ratio const &lhs, Ratio const &rhs) {
+            return lhs.m_value < rhs.m_value;
+        }
+
+        friend constexpr bool operator>(Ratio const &lhs, Ratio const &rhs) {
+            return lhs.m_value > rhs.m_value;
+        }
+
+        friend constexpr bool operator<=(Ratio const &lhs, Ratio const &rhs) {
+            return lhs.m_value <= rhs.m_value;
+        }
+
+        friend constexpr bool operator>=(Ratio const &lhs, Ratio const &rhs) {
+            return lhs.m_value >= rhs.m_value;
+        }
+
+    private:
+        explicit constexpr Ratio(ValueType value)
+                : m_value(value) {
+        }
+
+        ValueType m_value;
+    };
+
+    namespace detail {
+        constexpr int PositivePart(int exponent) {
+            return exponent > 0 ? exponent : 0;
+        }
+
+        /// Upper bound of log2(10^decades)
+        constexpr int DecadeBits(int decades) {
+            return (decades * 10 + 2) / 3;
+        }
+
+        /// T, or the next larger type of ValueSys with at least Digits bits, as far as ValueSys provides one
+        template<typename ValueSys, typename T, int Digits,
+                bool = (Digits > Limits<T>::digits) && (PositionOf<ValueSys, T>::value + 1 < Count<ValueSys>::value)>
+        struct WithDigits {
+            using type = T;
+        };
+
+        template<typename ValueSys, typename T, int Digits>
+        struct WithDigits<ValueSys, T, Digits, true>
+                : WithDigits<ValueSys, typename LargerType<ValueSys, T>::type, Digits> {
+        };
+
+        /// Bits of the dividend lhs * 10^decades * 2^FractionalBits and of the divisor rhs * 10^-decades of UnitRatio
+        template<typename Result, typename Lhs, typename Rhs>
+        struct RatioDigits {
+            static constexpr int Decades = DecadesDiff(Lhs::BasePrefix, Rhs::BasePrefix);
+            static constexpr int Dividend = Limits<typename Lhs::ValueType>::digits + DecadeBits(PositivePart(Decades))
+                                            + static_cast<int>(Result::Fractional());
+            static constexpr int Divisor = Limits<typename Rhs::ValueType>::digits + DecadeBits(PositivePart(-Decades));
+        };
+    }
+
+    /// @brief Division of two units of the same kind yielding a fixed-point Ratio
+    ///
+    /// (1) Both raw values are widened to the next larger type of the value system, or further if needed to hold
+    ///     the dividend of step (3).
+    /// (2) The operand with the coarser BasePrefix is scaled to the finer one, so no digit is lost.
+    /// (3) The dividend is shifted by FractionalBits and divided; the quotient is truncated towards zero.
+    /// (4) A quotient out of range of Result is narrowed according to the OverflowPolicy of Lhs.
+    ///
+    /// If the value system has no type wide enough for step (3), the intermediate results are computed with the
+    /// OverflowPolicy of Lhs as well; a saturated dividend then only bounds the quotient.
+    ///
+    /// Example: 3_V / 4000_mV with Ratio<int, 16>
+    ///          3000 * 2^16 / 4000 = 49152 = 0.75
+    ///
+    template<typename ValueSys, typename Result, typename Lhs, typename Rhs>
+    constexpr Result UnitRatio(Lhs const &lhs, Rhs const &rhs) {
+        static_assert(std::is_same<typename detail::UnitTag<Lhs>::type, typename detail::UnitTag<Rhs>::type>::value,
+                      "A dimensionless ratio requires units of the same kind");
+
+        using Digits = detail::RatioDigits<Result, Lhs, Rhs>;
+        using TCorrection = typename detail::WithDigits<ValueSys,
+                typename LargerType<ValueSys, typename Lhs::ValueType>::type,
+                std::max(Digits::Dividend, Digits::Divisor)>::type;
+        // Wrap-around cannot occur in a type wide enough, the policy checks are only needed otherwise
+        using Policy = typename std::conditional<
+                std::max(Digits::Dividend, Digits::Divisor) <= detail::Limits<TCorrection>::digits,
+                WrapOverflow, typename Lhs::OverflowPolicy>::type;
+
+        auto lhs_raw = Policy::template Scale<detail::PositivePart(Digits::Decades)>(
+                static_cast<TCorrection>(lhs.template To<Lhs::BasePrefix>()));
+        auto rhs_raw = Policy::template Scale<detail::PositivePart(-Digits::Decades)>(
+                static_cast<TCorrection>(rhs.template To<Rhs::BasePrefix>()));
+
+        auto quotient = Policy::Mul(lhs_raw, static_cast<TCorrection>(Result::OneRaw())) / rhs_raw;
+
+        LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckNarrow<Lhs, typename Result::ValueType>(
+                instrumentation::Operation::UnitRatio, quotient));
+
+        return Result::FromRaw(Lhs::OverflowPolicy::template Narrow<typename Result::ValueType>(quotient));
+    }
+
+    namespace detail {
+        /// ApplyRatio before the narrowing into Unit::ValueType
+        template<typename ValueSys, typename Unit, typename T, unsigned FractionalBits>
+        constexpr auto ApplyRatioWide(Unit const &unit, Ratio<T, FractionalBits> const &ratio) {
+            using MultValueType = typename MultiplicationResultHelper<ValueSys, typename Unit::ValueType, T>::type;
+
+            auto product = static_cast<MultValueType>(unit.template To<Unit::BasePrefix>()) * ratio.Raw();
+            auto scaled = product / static_cast<MultValueType>(Ratio<T, FractionalBits>::OneRaw());
+
+            LIGHTUNITS_INSTRUMENT(instrumentation::detail::CheckNarrow<Unit, typename Unit::ValueType>(
+                    instrumentation::Operation::ApplyRatio, scaled));
+
+            return scaled;
+        }
+    }
+
+    /// @brief Multiplication of a unit with a Ratio, yielding the same unit
+    ///
+    /// The product is formed in the next larger type of the value system and truncated towards zero.
+    ///
+    template<typename ValueSys, typename Unit, typename T, unsigned FractionalBits>
+    constexpr Unit ApplyRatio(Unit const &unit, Ratio<T, FractionalBits> const &ratio) {
+        return Unit::template From<Unit::BasePrefix>(
+                Unit::OverflowPolicy::template Narrow<typename Unit::ValueType>(
+                        detail::ApplyRatioWide<ValueSys>(unit, ratio)));
+    }
+
+    namespace detail {
+        /// @brief True if UnitRatioSimd computes UnitRatio exactly in double precision
+        ///
+        /// This requires 32 bit operands and results, and a dividend and divisor below 2^51, such that all
+        /// products of the remainder check are exact as well.
+        ///
+        template<typename Result, typename Lhs, typename Rhs>
+        struct RatioSimdExact : std::integral_constant<bool,
+                sizeof(typename Lhs::ValueType) == 4 && std::is_signed<typename Lhs::ValueType>::value &&
+                sizeof(typename Rhs::ValueType) == 4 && std::is_signed<typename Rhs::ValueType>::value &&
+                sizeof(typename Result::ValueType) == 4 && std::is_signed<typename Result::ValueType>::value &&
+                RatioDigits<Result, Lhs, Rhs>::Dividend <= 51 && RatioDigits<Result, Lhs, Rhs>::Divisor <= 51> {
+        };
+
+        template<typename ValueSys, typename Result, typename Lhs, typename Rhs>
+        std::size_t UnitRatioSimd(Lhs const *, Rhs const *, Result *, std::size_t, std::false_type) {
+            return 0;
+        }
+
+#if defined(__SSE2__)
+        /// @brief UnitRatio of two elements at a time by divpd
+        ///
+        /// The truncated quotient of the absolute values is corrected by the exact remainder, so the result equals
+        /// the integer division. Pairs with a zero divisor or a quotient out of the 32 bit range take the scalar
+        /// UnitRatio, which applies the OverflowPolicy.
+        ///
+        template<typename ValueSys, typename Result, typename Lhs, typename Rhs>
+        std::size_t UnitRatioSimd(Lhs const *lhs, Rhs const *rhs, Result *out, std::size_t size, std::true_type) {
+            constexpr int decades = RatioDigits<Result, Lhs, Rhs>::Decades;
+            __m128d const lhsScale = _mm_set1_pd(
+                    static_cast<double>(ExponentToMultiplier<PositivePart(decades)>::value) * Result::OneRaw());
+            __m128d const rhsScale = _mm_set1_pd(
+                    static_cast<double>(ExponentToMultiplier<PositivePart(-decades)>::value));
+            __m128d const signBit = _mm_set1_pd(-0.0);
+            __m128d const limit = _mm_set1_pd(2147483647.0);
+            __m128d const one = _mm_set1_pd(1.0);
+
+            auto const *lhsRaw = RawPointer(lhs);
+            auto const *rhsRaw = RawPointer(rhs);
+            auto *outRaw = reinterpret_cast<typename Result::ValueType *>(out);
+            std::size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                __m128d const num = _mm_mul_pd(
+                        _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(lhsRaw + i))), lhsScale);
+                __m128d const den = _mm_mul_pd(
+                        _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(rhsRaw + i))), rhsScale);
+                __m128d const numAbs = _mm_andnot_pd(signBit, num);
+                __m128d const denAbs = _mm_andnot_pd(signBit, den);
+                __m128d const q = _mm_div_pd(numAbs, denAbs);
+
+                // Infinity and NaN (zero divisor) fail the compare as well
+                if (_mm_movemask_pd(_mm_cmplt_pd(q, limit)) != 3) {
+                    out[i] = UnitRatio<ValueSys, Result>(lhs[i], rhs[i]);
+                    out[i + 1] = UnitRatio<ValueSys, Result>(lhs[i + 1], rhs[i + 1]);
+                    continue;
+                }
+
+                __m128d t = _mm_cvtepi32_pd(_mm_cvttpd_epi32(q));
+                __m128d const remainder = _mm_sub_pd(numAbs, _mm_mul_pd(t, denAbs));
+                t = _mm_sub_pd(t, _mm_and_pd(_mm_cmplt_pd(remainder, _mm_setzero_pd()), one));
+                t = _mm_add_pd(t, _mm_and_pd(_mm_cmpge_pd(remainder, denAbs), one));
+
+                __m128d const sign = _mm_and_pd(_mm_xor_pd(num, den), signBit);
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(outRaw + i), _mm_cvttpd_epi32(_mm_xor_pd(t, sign)));
+            }
+            return i;
+        }
+#endif
+    }
+
+    /// @brief Element-wise UnitRatio: out[i] = lhs[i] / rhs[i]
+    ///
+    /// All spans are expected to have the same size. For 32 bit units and ratios, SSE2 divides two elements at a
+    /// time in double precision where this is exact (see detail::RatioSimdExact); the results are identical to
+    /// UnitRatio. Everything else, and targets without SSE2, take one integer division per element.
+    ///
+    template<typename ValueSys, typename Result, typename LhsElem, typename RhsElem>
+    void UnitRatioBatch(UnitSpan<LhsElem> lhs, UnitSpan<RhsElem> rhs, UnitSpan<Result> out) {
+        using Lhs = typename std::remove_const<LhsElem>::type;
+        using Rhs = typename std::remove_const<RhsElem>::type;
+        assert(lhs.size() == rhs.size() && lhs.size() == out.size());
+
+        std::size_t const done = detail::UnitRatioSimd<ValueSys>(
+                static_cast<Lhs const *>(lhs.data()), static_cast<Rhs const *>(rhs.data()), out.data(), out.size(),
+                std::integral_constant<bool, detail::RatioSimdExact<Result, Lhs, Rhs>::value>());
+        for (std::size_t i = done; i < lhs.size(); ++i) {
+            out[i] = UnitRatio<ValueSys, Result>(lhs[i], rhs[i]);
+        }
+    }
+
+    /// @brief Applies one ratio to a whole buffer: out[i] = in[i] * ratio
+    ///
+    /// Per element a widening multiply and the division by OneRaw() (a shift with sign correction); the narrowing
+    /// into Unit follows block-wise by detail::NarrowBatch. in and out may refer to the same memory.
+    ///
+    template<typename ValueSys, typename Unit, typename UnitElem, typename T, unsigned FractionalBits>
+    void ApplyRatioBatch(UnitSpan<UnitElem> in, Ratio<T, FractionalBits> ratio, UnitSpan<Unit> out) {
+        assert(in.size() == out.size());
+
+        detail::NarrowingBatch(out.data(), out.size(), [&](std::size_t i) {
+            return detail::ApplyRatioWide<ValueSys>(in[i], ratio);
+        });
+    }
+
+    /// @brief Element-wise ApplyRatio: out[i] = in[i] * ratios[i]
+    ///
+    template<typename ValueSys, typename Unit, typename UnitElem, typename RatioElem>
+    void ApplyRatioBatch(UnitSpan<UnitElem> in, UnitSpan<RatioElem> ratios, UnitSpan<Unit> out) {
+        assert(in.size() == ratios.size() && in.size() == out.size());
+
+        detail::NarrowingBatch(out.data(), out.size(), [&](std::size_t i) {
+            return detail::ApplyRatioWide<ValueSys>(in[i], ratios[i]);
+        });
+    }
+}
@@ -0,0 +1,384 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "OverflowPolicy.hpp"
+#include "Ratio.hpp"
+#include "UnitSpan.hpp"
+#include "ValueSystem.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// Integer-only decimation and interpolation of unit streams
+///
+/// All filters keep their state between calls to Process(), so a stream can be fed block by block with
+/// arbitrary block sizes; the result is identical to processing it at once. The output has the unit (and
+/// therefore the BasePrefix) of the input. Results are truncated towards zero and narrowed according to the
+/// OverflowPolicy of the unit.
+
+namespace LightUnits {
+    namespace detail {
+        constexpr unsigned CeilLog2(unsigned long long val) {
+            unsigned bits = 0;
+            while ((1ULL << bits) < val) {
+                ++bits;
+            }
+            return bits;
+        }
+
+        template<typename T>
+        constexpr T IntegerPower(T base, unsigned exponent) {
+            T result = 1;
+            for (unsigned i = 0; i < exponent; ++i) {
+                result *= base;
+            }
+            return result;
+        }
+
+        template<typename Acc, typename Sample, typename Coefficient>
+        Acc DotProduct(Sample const *samples, Coefficient const *coefficients, std::size_t count, std::false_type) {
+            Acc acc = 0;
+            for (std::size_t k = 0; k < count; ++k) {
+                acc += static_cast<Acc>(samples[k]) * static_cast<Acc>(coefficients[k]);
+            }
+            return acc;
+        }
+
+        /// @brief int32 samples and coefficients summed in int64
+        ///
+        /// SSE2 has no signed widening multiply (pmuldq is SSE4.1), so four products at a time are formed by the
+        /// unsigned pmuludq. Each differs from the signed product by 2^32 * ((a < 0 ? b : 0) + (b < 0 ? a : 0))
+        /// modulo 2^64; these corrections are summed in 32 bit lanes, as only their lower 32 bits matter.
+        ///
+        template<typename Acc, typename Sample, typename Coefficient>
+        Acc DotProduct(Sample const *samples, Coefficient const *coefficients, std::size_t count, std::true_type) {
+            std::size_t k = 0;
+            std::uint64_t acc = 0;
+#if defined(__SSE2__)
+            __m128i products = _mm_setzero_si128();
+            __m128i corrections = _mm_setzero_si128();
+            for (; k + 4 <= count; k += 4) {
+                __m128i const a = _mm_loadu_si128(reinterpret_cast<__m128i const *>(samples + k));
+                __m128i const b = _mm_loadu_si128(reinterpret_cast<__m128i const *>(coefficients + k));
+                products = _mm_add_epi64(products, _mm_mul_epu32(a, b));
+                products = _mm_add_epi64(products, _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32)));
+                corrections = _mm_add_epi32(corrections, _mm_and_si128(_mm_srai_epi32(a, 31), b));
+                corrections = _mm_add_epi32(corrections, _mm_and_si128(_mm_srai_epi32(b, 31), a));
+            }
+            std::uint64_t productLanes[2];
+            std::uint32_t correctionLanes[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(productLanes), products);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(correctionLanes), corrections);
+            std::uint32_t const correction = correctionLanes[0] + correctionLanes[1] + correctionLanes[2] +
+                                             correctionLanes[3];
+            acc = productLanes[0] + productLanes[1] - (static_cast<std::uint64_t>(correction) << 32);
+#endif
+            // Wrapping sum, the result is exact whenever the dot product fits into Acc
+            for (; k < count; ++k) {
+                acc += static_cast<std::uint64_t>(static_cast<std::int64_t>(samples[k]) * coefficients[k]);
+            }
+            return static_cast<Acc>(acc);
+        }
+
+        template<typename Acc, typename Sample, typename Coefficient>
+        struct IsDotProduct32 : std::integral_constant<bool,
+                sizeof(Acc) == 8 && std::is_signed<Acc>::value &&
+                sizeof(Sample) == 4 && std::is_signed<Sample>::value && std::is_integral<Sample>::value &&
+                sizeof(Coefficient) == 4 && std::is_signed<Coefficient>::value &&
+                std::is_integral<Coefficient>::value> {
+        };
+
+        /// @brief Dot product of raw samples and fixed-point coefficients, accumulated in Acc
+        ///
+        /// int32 x int32 in int64 takes an explicit SSE2 kernel, see above. Other types use a plain loop.
+        ///
+        template<typename Acc, typename Sample, typename Coefficient>
+        Acc DotProduct(Sample const *samples, Coefficient const *coefficients, std::size_t count) {
+            return DotProduct<Acc>(samples, coefficients, count, IsDotProduct32<Acc, Sample, Coefficient>());
+        }
+    }
+
+    /// @brief Cascaded integrator-comb decimator (Hogenauer) with Order stages, differential delay 1
+    ///
+    /// Example: CicDecimator<IntegralValueSystem, Ampere, 3, 1000> reduces a 1 MHz current stream to 1 kHz
+    /// with 3 multiplications-free integrators per input sample and 3 combs per output sample.
+    ///
+    /// The integrators wrap around by design; the result is exact as long as the accumulator of the next larger
+    /// type of the ValueSystem holds the bit growth of Order * log2(Factor) bits, which is checked at compile time.
+    /// The output is normalized by the DC gain Factor^Order.
+    ///
+    template<typename ValueSys, typename Unit, unsigned Order, unsigned Factor>
+    class CicDecimator {
+    public:
+        using AccType = typename LargerType<ValueSys, typename Unit::ValueType>::type;
+
+        static_assert(Order >= 1 && Factor >= 1, "Order and factor have to be positive");
+        static_assert(detail::Limits<typename Unit::ValueType>::digits + Order * detail::CeilLog2(Factor)
+                      <= static_cast<unsigned>(detail::Limits<AccType>::digits),
+                      "Bit growth of the CIC filter exceeds the accumulator type");
+
+        /// Number of outputs produced by the next inputCount input samples
+        std::size_t OutputsFor(std::size_t inputCount) const {
+            return (m_phase + inputCount) / Factor;
+        }
+
+        /// @brief Consumes in and writes one output per Factor input samples to out
+        ///
+        /// out has to provide OutputsFor(in.size()) elements. Returns the number of outputs written.
+        ///
+        template<typename InElem>
+        std::size_t Process(UnitSpan<InElem> in, UnitSpan<Unit> out) {
+            assert(out.size() >= OutputsFor(in.size()));
+
+            std::size_t written = 0;
+            for (std::size_t i = 0; i < in.size(); ++i) {
+                AccType value = in[i].template To<Unit::BasePrefix>();
+                for (unsigned stage = 0; stage < Order; ++stage) {
+                    m_integrators[stage] = WrapOverflow::Add(m_integrators[stage], value);
+                    value = m_integrators[stage];
+                }
+
+                if (++m_phase == Factor) {
+                    m_phase = 0;
+                    out[written++] = Comb(value);
+                }
+            }
+            return written;
+        }
+
+        void Reset() {
+            *this = CicDecimator();
+        }
+
+    private:
+        static constexpr AccType Gain = detail::IntegerPower<AccType>(Factor, Order);
+
+        Unit Comb(AccType value) {
+            for (unsigned stage = 0; stage < Order; ++stage) {
+                AccType const delayed = m_combs[stage];
+                m_combs[stage] = value;
+                value = WrapOverflow::Sub(value, delayed);
+            }
+            return Unit::template From<Unit::BasePrefix>(
+                    Unit::OverflowPolicy::template Narrow<typename Unit::ValueType>(value / Gain));
+        }
+
+        AccType m_integrators[Order] = {};
+        AccType m_combs[Order] = {};
+        unsigned m_phase = 0;
+    };
+
+    template<typename ValueSys, typename Unit, unsigned Order, unsigned Factor>
+    constexpr typename CicDecimator<ValueSys, Unit, Order, Factor>::AccType CicDecimator<ValueSys, Unit, Order, Factor>::Gain;
+
+    /// @brief Cascaded integrator-comb interpolator with Order stages, differential delay 1
+    ///
+    /// Produces Factor output samples per input sample. The output is normalized by the DC gain
+    /// Factor^(Order - 1), so a constant input yields the same constant after the transient.
+    ///
+    template<typename ValueSys, typename Unit, unsigned Order, unsigned Factor>
+    class CicInterpolator {
+    public:
+        using AccType = typename LargerType<ValueSys, typename Unit::ValueType>::type;
+
+        static_assert(Order >= 1 && Factor >= 1, "Order and factor have to be positive");
+        static_assert(detail::Limits<typename Unit::ValueType>::digits + Order * detail::CeilLog2(Factor)
+                      <= static_cast<unsigned>(detail::Limits<AccType>::digits),
+                      "Bit growth of the CIC filter exceeds the accumulator type");
+
+        /// out has to provide Factor * in.size() elements. Returns the number of outputs written.
+        template<typename InElem>
+        std::size_t Process(UnitSpan<InElem> in, UnitSpan<Unit> out) {
+            assert(out.size() >= in.size() * Factor);
+
+            std::size_t written = 0;
+            for (std::size_t i = 0; i < in.size(); ++i) {
+                AccType value = in[i].template To<Unit::BasePrefix>();
+                for (unsigned stage = 0; stage < Order; ++stage) {
+                    AccType const delayed = m_combs[stage];
+                    m_combs[stage] = value;
+                    value = WrapOverflow::Sub(value, delayed);
+                }
+
+                // Zero stuffing: the comb output enters the integrators once, followed by Factor - 1 zeros
+                for (unsigned r = 0; r < Factor; ++r) {
+                    AccType integrated = (r == 0) ? value : AccType(0);
+                    for (unsigned stage = 0; stage < Order; ++stage) {
+                        m_integrators[stage] = WrapOverflow::Add(m_integrators[stage], integrated);
+                        integrated = m_integrators[stage];
+                    }
+                    out[written++] = Unit::template From<Unit::BasePrefix>(
+                            Unit::OverflowPolicy::template Narrow<typename Unit::ValueType>(integrated / Gain));
+                }
+            }
+            return written;
+        }
+
+        void Reset() {
+            *this = CicInterpolator();
+        }
+
+    private:
+        static constexpr AccType Gain = detail::IntegerPower<AccType>(Factor, Order - 1);
+
+        AccType m_integrators[Order] = {};
+        AccType m_combs[Order] = {};
+    };
+
+    template<typename ValueSys, typename Unit, unsigned Order, unsigned Factor>
+    constexpr typename CicInterpolator<ValueSys, Unit, Order, Factor>::AccType CicInterpolator<ValueSys, Unit, Order, Factor>::Gain;
+
+    /// @brief FIR decimator computing only every Factor-th output (polyphase decimation)
+    ///
+    /// y[m] = sum_k h[k] * x[m * Factor + Factor - 1 - k], i.e. an output is produced after every Factor inputs.
+    /// Coefficients are fixed-point Ratios; products are accumulated in the type resulting from the
+    /// multiplication of ValueType and coefficient type in the ValueSystem (int64 for 32 bit values).
+    ///
+    /// Example: 4 taps of Ratio 0.25 and factor 4 yield the average of every 4 samples.
+    ///
+    template<typename ValueSys, typename Unit, typename CoefficientType, unsigned FractionalBits>
+    class PolyphaseDecimator {
+    public:
+        using Coefficient = Ratio<CoefficientType, FractionalBits>;
+        using AccType = typename MultiplicationResultHelper<ValueSys, typename Unit::ValueType, CoefficientType>::type;
+
+        PolyphaseDecimator(std::vector<Coefficient> const &taps, std::size_t factor)
+                : m_factor(factor),
+                  m_taps(taps.size()),
+                  m_history(taps.size() - 1, 0) {
+            assert(!taps.empty() && factor >= 1);
+            // Reversed, so the window of samples and the coefficients are traversed in the same direction
+            m_reversed.reserve(taps.size());
+            for (auto it = taps.rbegin(); it != taps.rend(); ++it) {
+                m_reversed.push_back(it->Raw());
+            }
+        }
+
+        std::size_t OutputsFor(std::size_t inputCount) const {
+            return (m_phase + inputCount) / m_factor;
+        }
+
+        /// out has to provide OutputsFor(in.size()) elements. Returns the number of outputs written.
+        template<typename InElem>
+        std::size_t Process(UnitSpan<InElem> in, UnitSpan<Unit> out) {
+            assert(out.size() >= OutputsFor(in.size()));
+
+            std::size_t const history = m_taps - 1;
+            for (auto const &sample : in) {
+                m_history.push_back(sample.template To<Unit::BasePrefix>());
+            }
+
+            std::size_t written = 0;
+            // Position of the newest sample of the first output within m_history
+            for (std::size_t last = history + (m_factor - 1 - m_phase); last < m_history.size(); last += m_factor) {
+                AccType const acc = detail::DotProduct<AccType>(&m_history[last + 1 - m_taps], m_reversed.data(),
+                                                                m_taps);
+                out[written++] = ToUnit(acc);
+            }
+
+            m_phase = (m_phase + in.size()) % m_factor;
+            m_history.erase(m_history.begin(), m_history.end() - static_cast<std::ptrdiff_t>(history));
+            return written;
+        }
+
+        void Reset() {
+            std::fill(m_history.begin(), m_history.end(), 0);
+            m_phase = 0;
+        }
+
+    private:
+        static Unit ToUnit(AccType acc) {
+            return Unit::template From<Unit::BasePrefix>(Unit::OverflowPolicy::template Narrow<typename Unit::ValueType>(
+                    acc / static_cast<AccType>(Coefficient::OneRaw())));
+        }
+
+        std::size_t m_factor;
+        std::size_t m_taps;
+        std::size_t m_phase = 0;
+        std::vector<CoefficientType> m_reversed;
+        std::vector<typename Unit::ValueType> m_history;
+    };
+
+    /// @brief FIR interpolator split into Factor sub-filters (polyphase interpolation)
+    ///
+    /// Equivalent to inserting Factor - 1 zeros after each input sample and filtering with h, without the
+    /// multiplications by zero: output p of input n is sum_k h[p + k * Factor] * x[n - k].
+    /// For unity gain, the coefficients have to sum up to Factor.
+    ///
+    template<typename ValueSys, typename Unit, typename CoefficientType, unsigned FractionalBits>
+    class PolyphaseInterpolator {
+    public:
+        using Coefficient = Ratio<CoefficientType, FractionalBits>;
+        using AccType = typename MultiplicationResultHelper<ValueSys, typename Unit::ValueType, CoefficientType>::type;
+
+        PolyphaseInterpolator(std::vector<Coefficient> const &taps, std::size_t factor)
+                : m_factor(factor),
+                  m_phaseTaps((taps.size() + factor - 1) / factor),
+                  m_subFilters(factor * m_phaseTaps, 0),
+                  m_history(m_phaseTaps - 1, 0) {
+            assert(!taps.empty() && factor >= 1);
+            // Sub-filter p holds h[p], h[p + Factor], ... in reversed order, padded with zeros
+            for (std::size_t p = 0; p < factor; ++p) {
+                for (std::size_t k = 0; k < m_phaseTaps && p + k * factor < taps.size(); ++k) {
+                    m_subFilters[p * m_phaseTaps + (m_phaseTaps - 1 - k)] = taps[p + k * factor].Raw();
+                }
+            }
+        }
+
+        /// out has to provide Factor * in.size() elements. Returns the number of outputs written.
+        template<typename InElem>
+        std::size_t Process(UnitSpan<InElem> in, UnitSpan<Unit> out) {
+            assert(out.size() >= in.size() * m_factor);
+
+            for (auto const &sample : in) {
+                m_history.push_back(sample.template To<Unit::BasePrefix>());
+            }
+
+            std::size_t written = 0;
+            for (std::size_t n = m_phaseTaps - 1; n < m_history.size(); ++n) {
+                auto const *window = &m_history[n + 1 - m_phaseTaps];
+                for (std::size_t p = 0; p < m_factor; ++p) {
+                    AccType const acc = detail::DotProduct<AccType>(window, &m_subFilters[p * m_phaseTaps],
+                                                                    m_phaseTaps);
+                    out[written++] = Unit::template From<Unit::BasePrefix>(
+                            Unit::OverflowPolicy::template Narrow<typename Unit::ValueType>(
+                                    acc / static_cast<AccType>(Coefficient::OneRaw())));
+                }
+            }
+
+            m_history.erase(m_history.begin(), m_history.end() - static_cast<std::ptrdiff_t>(m_phaseTaps - 1));
+            return written;
+        }
+
+        void Reset() {
+            std::fill(m_history.begin(), m_history.end(), 0);
+        }
+
+    private:
+        std::size_t m_factor;
+        std::size_t m_phaseTaps;
+        std::vector<CoefficientType> m_subFilters;
+        std::vector<typename Unit::ValueType> m_history;
+    };
+}
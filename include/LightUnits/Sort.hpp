@@ -0,0 +1,443 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "BitOps.hpp"
+#include "UnitSpan.hpp"
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/// Sorting and selection kernels for unit buffers
+///
+/// All kernels operate on the raw values in the units' BasePrefix. Signed values are mapped onto unsigned keys
+/// of the same order by flipping the sign bit (detail::OrderedKey), so no comparisons are needed.
+/// The parallel variants use std::thread and therefore require linking against a thread library.
+
+namespace LightUnits {
+    namespace detail {
+        constexpr unsigned RadixBits = 8;
+        constexpr std::size_t RadixBuckets = std::size_t(1) << RadixBits;
+
+        /// Below this size the parallel sort falls back to the sequential one
+        constexpr std::size_t ParallelSortMinSize = std::size_t(1) << 16;
+
+        template<typename Unit>
+        using SortKey = typename std::make_unsigned<typename Unit::ValueType>::type;
+
+        template<typename Unit>
+        SortKey<Unit> KeyOf(Unit const &unit) {
+            return OrderedKey(unit.template To<Unit::BasePrefix>());
+        }
+
+        template<typename Unit>
+        Unit UnitOfKey(SortKey<Unit> key) {
+            return Unit::template From<Unit::BasePrefix>(FromOrderedKey<typename Unit::ValueType>(key));
+        }
+
+        /// Key for sorting in ascending order, or in descending order on the inverted key
+        template<bool Descending, typename Unit>
+        SortKey<Unit> DirectedKeyOf(Unit const &unit) {
+            return Descending ? static_cast<SortKey<Unit>>(~KeyOf(unit)) : KeyOf(unit);
+        }
+
+        template<bool Descending = false, typename Unit>
+        std::size_t DigitOf(Unit const &unit, unsigned pass) {
+            auto const key = DirectedKeyOf<Descending>(unit);
+            return static_cast<std::size_t>((key >> (pass * RadixBits)) & (RadixBuckets - 1));
+        }
+
+        /// Placeholder for sorts without payload column; all payload operations vanish
+        struct NoPayload {
+        };
+
+        template<typename Payload>
+        void MovePayload(Payload *dst, std::size_t dstIndex, Payload const *src, std::size_t srcIndex) {
+            dst[dstIndex] = src[srcIndex];
+        }
+
+        inline void MovePayload(NoPayload *, std::size_t, NoPayload const *, std::size_t) {
+        }
+
+        template<typename Payload>
+        void CopyPayload(Payload *dst, Payload const *src, std::size_t count) {
+            std::copy(src, src + count, dst);
+        }
+
+        inline void CopyPayload(NoPayload *, NoPayload const *, std::size_t) {
+        }
+
+        /// Runs fn(0) ... fn(threads - 1) concurrently, fn(0) on the calling thread
+        template<typename Fn>
+        void ParallelFor(unsigned threads, Fn fn) {
+            std::vector<std::thread> workers;
+            workers.reserve(threads - 1);
+            for (unsigned t = 1; t < threads; ++t) {
+                workers.emplace_back(fn, t);
+            }
+            fn(0u);
+            for (auto &worker : workers) {
+                worker.join();
+            }
+        }
+
+        /// @brief Reusable barrier for a fixed number of threads
+        ///
+        /// The last thread to arrive runs the completion function before any of the threads continues.
+        ///
+        class Barrier {
+        public:
+            explicit Barrier(unsigned threads)
+                    : m_threads(threads) {
+            }
+
+            template<typename Fn>
+            void Wait(Fn completion) {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                unsigned const generation = m_generation;
+                if (++m_arrived == m_threads) {
+                    completion();
+                    m_arrived = 0;
+                    ++m_generation;
+                    m_released.notify_all();
+                } else {
+                    m_released.wait(lock, [&] { return generation != m_generation; });
+                }
+            }
+
+            void Wait() {
+                Wait([] {});
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::condition_variable m_released;
+            unsigned const m_threads;
+            unsigned m_arrived = 0;
+            unsigned m_generation = 0;
+        };
+
+        /// @brief Stable LSD radix sort of values (and payload) using scratch buffers of the same size
+        ///
+        /// Histograms of all digits are gathered in one pass upfront. Passes in which all keys share the same
+        /// digit (e.g. the upper bytes of small values) are skipped. Descending sorts on the inverted keys, which
+        /// keeps equal values in their original order as well.
+        ///
+        template<typename Unit, typename Payload, bool Descending = false>
+        void RadixSortImpl(Unit *values, Payload *payload, std::size_t size, Unit *scratch, Payload *payloadScratch) {
+            constexpr unsigned Passes = sizeof(SortKey<Unit>);
+
+            std::size_t counts[Passes][RadixBuckets] = {};
+            for (std::size_t i = 0; i < size; ++i) {
+                auto const key = DirectedKeyOf<Descending>(values[i]);
+                for (unsigned pass = 0; pass < Passes; ++pass) {
+                    ++counts[pass][(key >> (pass * RadixBits)) & (RadixBuckets - 1)];
+                }
+            }
+
+            Unit *src = values;
+            Unit *dst = scratch;
+            Payload *payloadSrc = payload;
+            Payload *payloadDst = payloadScratch;
+
+            for (unsigned pass = 0; pass < Passes; ++pass) {
+                if (size == 0 || counts[pass][DigitOf<Descending>(src[0], pass)] == size) {
+                    continue;
+                }
+
+                std::size_t offsets[RadixBuckets];
+                std::size_t sum = 0;
+                for (std::size_t digit = 0; digit < RadixBuckets; ++digit) {
+                    offsets[digit] = sum;
+                    sum += counts[pass][digit];
+                }
+
+                for (std::size_t i = 0; i < size; ++i) {
+                    std::size_t const pos = offsets[DigitOf<Descending>(src[i], pass)]++;
+                    dst[pos] = src[i];
+                    MovePayload(payloadDst, pos, payloadSrc, i);
+                }
+
+                std::swap(src, dst);
+                std::swap(payloadSrc, payloadDst);
+            }
+
+            if (src != values) {
+                std::copy(src, src + size, values);
+                CopyPayload(payload, payloadSrc, size);
+            }
+        }
+
+        /// @brief Parallel stable LSD radix sort
+        ///
+        /// Each thread owns a contiguous chunk. Per pass, the threads count the digits of their chunk, the
+        /// offsets are derived sequentially (thread order preserves stability), then all threads scatter.
+        /// The threads are started once for all passes; barriers separate the counting from the scattering
+        /// and the scattering from the next pass.
+        ///
+        template<typename Unit, typename Payload>
+        void ParallelRadixSortImpl(Unit *values, Payload *payload, std::size_t size, Unit *scratch,
+                                   Payload *payloadScratch, unsigned threads) {
+            constexpr unsigned Passes = sizeof(SortKey<Unit>);
+
+            std::size_t const chunk = (size + threads - 1) / threads;
+            std::vector<std::size_t> offsets(threads * RadixBuckets);
+            Barrier barrier(threads);
+            bool skip = false;  // Written by the completion of the counting barrier only
+
+            // Derives the scatter positions of all threads from their counts, or skips the pass
+            auto const prefixSums = [&](Unit const *src, unsigned pass) {
+                std::size_t const firstDigit = DigitOf(src[0], pass);
+                std::size_t firstDigitCount = 0;
+                for (unsigned t = 0; t < threads; ++t) {
+                    firstDigitCount += offsets[t * RadixBuckets + firstDigit];
+                }
+                skip = firstDigitCount == size;
+                if (skip) {
+                    return;
+                }
+
+                std::size_t sum = 0;
+                for (std::size_t digit = 0; digit < RadixBuckets; ++digit) {
+                    for (unsigned t = 0; t < threads; ++t) {
+                        std::size_t const count = offsets[t * RadixBuckets + digit];
+                        offsets[t * RadixBuckets + digit] = sum;
+                        sum += count;
+                    }
+                }
+            };
+
+            // Every thread follows the same sequence of buffer swaps, the result is in src of any of them
+            Unit *result = values;
+            Payload *payloadResult = payload;
+
+            ParallelFor(threads, [&](unsigned t) {
+                Unit *src = values;
+                Unit *dst = scratch;
+                Payload *payloadSrc = payload;
+                Payload *payloadDst = payloadScratch;
+
+                std::size_t *positions = &offsets[t * RadixBuckets];
+                std::size_t const begin = std::min(size, t * chunk);
+                std::size_t const end = std::min(size, (t + 1) * chunk);
+
+                for (unsigned pass = 0; pass < Passes; ++pass) {
+                    std::fill(positions, positions + RadixBuckets, 0);
+                    for (std::size_t i = begin; i < end; ++i) {
+                        ++positions[DigitOf(src[i], pass)];
+                    }
+                    barrier.Wait([&] { prefixSums(src, pass); });
+                    if (skip) {
+                        continue;
+                    }
+
+                    for (std::size_t i = begin; i < end; ++i) {
+                        std::size_t const pos = positions[DigitOf(src[i], pass)]++;
+                        dst[pos] = src[i];
+                        MovePayload(payloadDst, pos, payloadSrc, i);
+                    }
+                    barrier.Wait();
+
+                    std::swap(src, dst);
+                    std::swap(payloadSrc, payloadDst);
+                }
+
+                if (t == 0) {
+                    result = src;
+                    payloadResult = payloadSrc;
+                }
+            });
+
+            if (result != values) {
+                std::copy(result, result + size, values);
+                CopyPayload(payload, payloadResult, size);
+            }
+        }
+
+        /// @brief Key of the element at position rank (0-based) if the keys were sorted, without modifying them
+        ///
+        /// MSD radix select: each pass counts the next digit of all keys sharing the digits determined so far.
+        /// The counting loop is branch-free; one pass per byte of the key.
+        ///
+        template<typename Unit>
+        SortKey<Unit> SelectKey(Unit const *values, std::size_t size, std::size_t rank) {
+            using Key = SortKey<Unit>;
+            constexpr unsigned Passes = sizeof(Key);
+
+            Key prefix = 0;
+            Key prefixMask = 0;
+            for (unsigned pass = Passes; pass-- > 0;) {
+                unsigned const shift = pass * RadixBits;
+
+                std::size_t counts[RadixBuckets] = {};
+                for (std::size_t i = 0; i < size; ++i) {
+                    Key const key = KeyOf(values[i]);
+                    counts[(key >> shift) & (RadixBuckets - 1)] += ((key & prefixMask) == prefix) ? 1u : 0u;
+                }
+
+                std::size_t digit = 0;
+                while (rank >= counts[digit]) {
+                    rank -= counts[digit];
+                    ++digit;
+                }
+
+                prefix = static_cast<Key>(prefix | (static_cast<Key>(digit) << shift));
+                prefixMask = static_cast<Key>(prefixMask | (static_cast<Key>(RadixBuckets - 1) << shift));
+            }
+            return prefix;
+        }
+
+        template<typename Unit, typename PayloadElem>
+        void TopKImpl(UnitSpan<Unit const> values, PayloadElem const *payload, std::size_t k,
+                      UnitSpan<Unit> out, PayloadElem *payloadOut) {
+            assert(k <= values.size() && out.size() == k);
+            if (k == 0) {
+                return;
+            }
+
+            auto const threshold = SelectKey(values.data(), values.size(), values.size() - k);
+
+            // All keys above the threshold belong to the result, keys equal to it fill the remaining places
+            std::size_t greater = 0;
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                greater += (KeyOf(values[i]) > threshold) ? 1u : 0u;
+            }
+            std::size_t equalSlots = k - greater;
+
+            std::size_t pos = 0;
+            for (std::size_t i = 0; i < values.size() && pos < k; ++i) {
+                auto const key = KeyOf(values[i]);
+                bool const take = key > threshold || (key == threshold && equalSlots > 0);
+                if (take) {
+                    equalSlots -= (key == threshold) ? 1u : 0u;
+                    out[pos] = values[i];
+                    MovePayload(payloadOut, pos, payload, i);
+                    ++pos;
+                }
+            }
+
+            std::vector<Unit> scratch(k);
+            std::vector<PayloadElem> payloadScratch(std::is_same<PayloadElem, NoPayload>::value ? 0 : k);
+            RadixSortImpl<Unit, PayloadElem, true>(out.data(), payloadOut, k, scratch.data(), payloadScratch.data());
+        }
+    }
+
+    /// @brief Sorts the values in ascending order (stable LSD radix sort)
+    ///
+    template<typename Unit>
+    void RadixSort(UnitSpan<Unit> values) {
+        std::vector<Unit> scratch(values.size());
+        detail::RadixSortImpl<Unit, detail::NoPayload>(values.data(), nullptr, values.size(), scratch.data(), nullptr);
+    }
+
+    /// @brief Sorts the values in ascending order and applies the same permutation to payload
+    ///
+    /// Example: sort current samples and keep their timestamps aligned, without an index array
+    ///
+    template<typename Unit, typename Payload>
+    void RadixSort(UnitSpan<Unit> values, UnitSpan<Payload> payload) {
+        assert(values.size() == payload.size());
+
+        std::vector<Unit> scratch(values.size());
+        std::vector<Payload> payloadScratch(payload.size());
+        detail::RadixSortImpl(values.data(), payload.data(), values.size(), scratch.data(), payloadScratch.data());
+    }
+
+    /// @brief Multi-threaded RadixSort; produces the same order as the sequential one
+    ///
+    /// threads == 0 selects std::thread::hardware_concurrency().
+    ///
+    template<typename Unit>
+    void ParallelRadixSort(UnitSpan<Unit> values, unsigned threads = 0) {
+        threads = threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+        if (threads == 1 || values.size() < detail::ParallelSortMinSize) {
+            RadixSort(values);
+            return;
+        }
+        std::vector<Unit> scratch(values.size());
+        detail::ParallelRadixSortImpl<Unit, detail::NoPayload>(values.data(), nullptr, values.size(),
+                                                               scratch.data(), nullptr, threads);
+    }
+
+    /// \sa ParallelRadixSort
+    template<typename Unit, typename Payload>
+    void ParallelRadixSort(UnitSpan<Unit> values, UnitSpan<Payload> payload, unsigned threads = 0) {
+        assert(values.size() == payload.size());
+
+        threads = threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+        if (threads == 1 || values.size() < detail::ParallelSortMinSize) {
+            RadixSort(values, payload);
+            return;
+        }
+        std::vector<Unit> scratch(values.size());
+        std::vector<Payload> payloadScratch(payload.size());
+        detail::ParallelRadixSortImpl(values.data(), payload.data(), values.size(), scratch.data(),
+                                      payloadScratch.data(), threads);
+    }
+
+    /// @brief Value at position n (0-based) of the sorted sequence; values are not modified
+    ///
+    /// Example: SelectNth(samples, samples.size() / 2) is the median
+    ///
+    template<typename UnitElem>
+    typename std::remove_const<UnitElem>::type SelectNth(UnitSpan<UnitElem> values, std::size_t n) {
+        using Unit = typename std::remove_const<UnitElem>::type;
+        assert(n < values.size());
+
+        return detail::UnitOfKey<Unit>(detail::SelectKey<Unit>(values.data(), values.size(), n));
+    }
+
+    /// @brief Rearranges values like std::nth_element and returns the value at position n
+    ///
+    /// Afterwards values[n] holds the value at position n of the sorted sequence, no value before it is
+    /// larger and no value after it is smaller.
+    ///
+    template<typename Unit>
+    Unit NthElement(UnitSpan<Unit> values, std::size_t n) {
+        auto const pivot = detail::SelectKey<Unit>(values.data(), values.size(), n);
+
+        auto const lessEnd = std::partition(values.begin(), values.end(),
+                                            [pivot](Unit const &u) { return detail::KeyOf(u) < pivot; });
+        std::partition(lessEnd, values.end(), [pivot](Unit const &u) { return detail::KeyOf(u) == pivot; });
+        return values[n];
+    }
+
+    /// @brief The k largest values in descending order
+    ///
+    /// out has to have size k. Among equal values, those occurring first in values are taken, and they keep
+    /// their order of occurrence in out.
+    ///
+    template<typename UnitElem, typename Unit>
+    void TopK(UnitSpan<UnitElem> values, std::size_t k, UnitSpan<Unit> out) {
+        detail::TopKImpl<Unit, detail::NoPayload>(values, nullptr, k, out, nullptr);
+    }
+
+    /// @brief TopK which also returns the payload belonging to each selected value
+    ///
+    template<typename UnitElem, typename PayloadElem, typename Unit, typename Payload>
+    void TopK(UnitSpan<UnitElem> values, UnitSpan<PayloadElem> payload, std::size_t k,
+              UnitSpan<Unit> out, UnitSpan<Payload> payloadOut) {
+        assert(values.size() == payload.size() && payloadOut.size() == k);
+
+        detail::TopKImpl<Unit, Payload>(values, payload.data(), k, out, payloadOut.data());
+    }
+}
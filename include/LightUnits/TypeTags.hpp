@@ -23,4 +23,6 @@ namespace LightUnits {
     struct Volt_t;
     struct Ohm_t;
     struct Second_t;
+    struct Watt_t;
+    struct Joule_t;
 }
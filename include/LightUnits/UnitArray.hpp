@@ -0,0 +1,114 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "UnitSpan.hpp"
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+namespace LightUnits {
+    /// @brief Owning, contiguous and resizable buffer of units
+    ///
+    /// Storage for the batch kernels. Use Span() to obtain the views they operate on.
+    /// New elements are value-initialized, i.e. hold a raw value of 0.
+    ///
+    template<typename Unit>
+    class UnitArray {
+    public:
+        using value_type = Unit;
+        using size_type = std::size_t;
+        using iterator = Unit *;
+        using const_iterator = Unit const *;
+
+        UnitArray() = default;
+
+        explicit UnitArray(size_type size)
+                : m_data(size) {
+        }
+
+        UnitArray(std::initializer_list<Unit> values)
+                : m_data(values) {
+        }
+
+        Unit *data() {
+            return m_data.data();
+        }
+
+        Unit const *data() const {
+            return m_data.data();
+        }
+
+        size_type size() const {
+            return m_data.size();
+        }
+
+        bool empty() const {
+            return m_data.empty();
+        }
+
+        Unit &operator[](size_type index) {
+            return m_data[index];
+        }
+
+        Unit const &operator[](size_type index) const {
+            return m_data[index];
+        }
+
+        iterator begin() {
+            return m_data.data();
+        }
+
+        iterator end() {
+            return m_data.data() + m_data.size();
+        }
+
+        const_iterator begin() const {
+            return m_data.data();
+        }
+
+        const_iterator end() const {
+            return m_data.data() + m_data.size();
+        }
+
+        void resize(size_type size) {
+            m_data.resize(size);
+        }
+
+        void reserve(size_type capacity) {
+            m_data.reserve(capacity);
+        }
+
+        void clear() {
+            m_data.clear();
+        }
+
+        void push_back(Unit const &value) {
+            m_data.push_back(value);
+        }
+
+        UnitSpan<Unit> Span() {
+            return {m_data.data(), m_data.size()};
+        }
+
+        UnitSpan<Unit const> Span() const {
+            return {m_data.data(), m_data.size()};
+        }
+
+    private:
+        std::vector<Unit> m_data;
+    };
+}
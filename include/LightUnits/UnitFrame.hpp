@@ -0,0 +1,284 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "GenericConversions.hpp"
+#include "MultiplyWithExponent.hpp"
+#include "Prefix.hpp"
+#include "UnitArray.hpp"
+#include "UnitSpan.hpp"
+#include "ValueSystem.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace LightUnits {
+    /// Row indices of a UnitFrame, in ascending order
+    using SelectionVector = std::vector<std::uint32_t>;
+
+    namespace detail {
+        /// Rows per block of the fused kernels. 1024 rows of a few 32 bit columns fit comfortably into L1.
+        constexpr std::size_t FrameBlockRows = 1024;
+    }
+
+    /// @brief Cumulative integral of a unit over time using the trapezoidal rule
+    ///
+    /// Example: Joule from Watt and Second
+    ///
+    /// The running sum is kept in the unscaled product of the raw values (e.g. mW * us), so the truncation
+    /// towards the BasePrefix of the result happens once per query and does not accumulate over many samples.
+    /// The state is kept between calls, so consecutive buffers of one stream can be fed in block by block.
+    ///
+    template<typename ValueSys, typename Result, typename In, typename Time>
+    class TrapezoidIntegrator {
+    public:
+        using AccType = typename MultiplicationResultHelper<ValueSys, typename In::ValueType, typename Time::ValueType>::type;
+
+        /// Consumes the next sample and returns the integral from the first sample up to this one
+        Result Push(In const &value, Time const &time) {
+            AccType const value_raw = value.template To<In::BasePrefix>();
+            AccType const time_raw = time.template To<Time::BasePrefix>();
+
+            if (m_started) {
+                m_twiceIntegral += (value_raw + m_previousValue) * (time_raw - m_previousTime);
+            }
+
+            m_started = true;
+            m_previousValue = value_raw;
+            m_previousTime = time_raw;
+            return Current();
+        }
+
+        Result Current() const {
+            using Policy = typename Result::OverflowPolicy;
+            auto integral = Policy::template Scale<
+                    detail::DimensionCorrectionFromMult(Result::BasePrefix, In::BasePrefix, Time::BasePrefix)>(
+                    m_twiceIntegral / 2);
+
+            return Result::template From<Result::BasePrefix>(
+                    Policy::template Narrow<typename Result::ValueType>(integral));
+        }
+
+        void Reset() {
+            *this = TrapezoidIntegrator();
+        }
+
+    private:
+        AccType m_twiceIntegral = 0;
+        AccType m_previousValue = 0;
+        AccType m_previousTime = 0;
+        bool m_started = false;
+    };
+
+    /// @brief out[i] = integral of in over time from row 0 to row i
+    ///
+    /// \sa TrapezoidIntegrator
+    ///
+    template<typename ValueSys, typename Result, typename InElem, typename TimeElem>
+    void IntegrateBatch(UnitSpan<InElem> in, UnitSpan<TimeElem> time, UnitSpan<Result> out) {
+        assert(in.size() == time.size() && in.size() == out.size());
+
+        using In = typename std::remove_const<InElem>::type;
+        using Time = typename std::remove_const<TimeElem>::type;
+
+        TrapezoidIntegrator<ValueSys, Result, In, Time> integrator;
+        for (std::size_t i = 0; i < in.size(); ++i) {
+            out[i] = integrator.Push(in[i], time[i]);
+        }
+    }
+
+    /// @brief Fused computation of power = voltage * current and energy = integral of power over time
+    ///
+    /// The rows are processed in blocks: the products of one block are computed by a loop without dependencies
+    /// between iterations (vectorizable), then the block is integrated while it is still in cache.
+    ///
+    template<typename ValueSys, typename Power, typename Energy, typename VoltElem, typename CurrentElem, typename TimeElem>
+    void PowerEnergyBatch(UnitSpan<VoltElem> voltage, UnitSpan<CurrentElem> current, UnitSpan<TimeElem> time,
+                          UnitSpan<Power> power, UnitSpan<Energy> energy) {
+        std::size_t const rows = voltage.size();
+        assert(current.size() == rows && time.size() == rows && power.size() == rows && energy.size() == rows);
+
+        using Time = typename std::remove_const<TimeElem>::type;
+
+        TrapezoidIntegrator<ValueSys, Energy, Power, Time> integrator;
+        for (std::size_t start = 0; start < rows; start += detail::FrameBlockRows) {
+            std::size_t const count = std::min(detail::FrameBlockRows, rows - start);
+
+            auto powerBlock = power.subspan(start, count);
+            UnitMultBatch<ValueSys>(voltage.subspan(start, count), current.subspan(start, count), powerBlock);
+
+            for (std::size_t i = 0; i < count; ++i) {
+                energy[start + i] = integrator.Push(powerBlock[i], time[start + i]);
+            }
+        }
+    }
+
+    /// @brief Columnar table in which every column is a typed unit buffer
+    ///
+    /// Example: UnitFrame<Second, Volt, Ampere, Watt, Joule>
+    ///          Columns are addressed by their index, as several columns may share a unit (e.g. one per phase).
+    ///
+    /// Row filters yield a SelectionVector of matching row indices instead of copying rows.
+    /// Derived columns are filled by DeriveProduct, DeriveIntegral and DerivePowerAndEnergy.
+    ///
+    template<typename ... Columns>
+    class UnitFrame {
+    public:
+        static constexpr std::size_t ColumnCount = sizeof...(Columns);
+
+        template<std::size_t I>
+        using ColumnType = typename std::tuple_element<I, std::tuple<Columns...>>::type;
+
+        UnitFrame() = default;
+
+        explicit UnitFrame(std::size_t rows) {
+            Resize(rows);
+        }
+
+        std::size_t Rows() const {
+            return m_rows;
+        }
+
+        /// New rows hold a raw value of 0 in every column
+        void Resize(std::size_t rows) {
+            ResizeImpl(rows, std::index_sequence_for<Columns...>());
+            m_rows = rows;
+        }
+
+        void Reserve(std::size_t rows) {
+            ReserveImpl(rows, std::index_sequence_for<Columns...>());
+        }
+
+        void AppendRow(Columns const &... values) {
+            AppendRowImpl(std::index_sequence_for<Columns...>(), values...);
+            ++m_rows;
+        }
+
+        template<std::size_t I>
+        UnitSpan<ColumnType<I>> Column() {
+            return std::get<I>(m_columns).Span();
+        }
+
+        template<std::size_t I>
+        UnitSpan<ColumnType<I> const> Column() const {
+            return std::get<I>(m_columns).Span();
+        }
+
+        /// @brief Indices of all rows for which pred(Column<I>()[row]) holds
+        ///
+        /// The loop stores every index and advances the output position by the predicate result, so it contains
+        /// no data-dependent branch.
+        ///
+        template<std::size_t I, typename Predicate>
+        SelectionVector Select(Predicate pred) const {
+            assert(m_rows <= std::numeric_limits<std::uint32_t>::max());
+
+            auto const column = Column<I>();
+            SelectionVector selection(m_rows);
+            std::size_t count = 0;
+            for (std::size_t row = 0; row < m_rows; ++row) {
+                selection[count] = static_cast<std::uint32_t>(row);
+                count += pred(column[row]) ? 1u : 0u;
+            }
+            selection.resize(count);
+            return selection;
+        }
+
+        /// @brief Subset of candidates for which pred(Column<I>()[row]) holds, e.g. to combine filters
+        ///
+        template<std::size_t I, typename Predicate>
+        SelectionVector Select(SelectionVector const &candidates, Predicate pred) const {
+            auto const column = Column<I>();
+            SelectionVector selection(candidates.size());
+            std::size_t count = 0;
+            for (auto const row : candidates) {
+                selection[count] = row;
+                count += pred(column[row]) ? 1u : 0u;
+            }
+            selection.resize(count);
+            return selection;
+        }
+
+        /// Copies the selected rows of one column, for consumers which require contiguous data
+        template<std::size_t I>
+        UnitArray<ColumnType<I>> Gather(SelectionVector const &selection) const {
+            auto const column = Column<I>();
+            UnitArray<ColumnType<I>> result(selection.size());
+            for (std::size_t i = 0; i < selection.size(); ++i) {
+                result[i] = column[selection[i]];
+            }
+            return result;
+        }
+
+    private:
+        template<std::size_t ... I>
+        void ResizeImpl(std::size_t rows, std::index_sequence<I...>) {
+            int expand[] = {0, (std::get<I>(m_columns).resize(rows), 0)...};
+            (void) expand;
+        }
+
+        template<std::size_t ... I>
+        void ReserveImpl(std::size_t rows, std::index_sequence<I...>) {
+            int expand[] = {0, (std::get<I>(m_columns).reserve(rows), 0)...};
+            (void) expand;
+        }
+
+        template<std::size_t ... I>
+        void AppendRowImpl(std::index_sequence<I...>, Columns const &... values) {
+            int expand[] = {0, (std::get<I>(m_columns).push_back(values), 0)...};
+            (void) expand;
+        }
+
+        std::tuple<UnitArray<Columns>...> m_columns;
+        std::size_t m_rows = 0;
+    };
+
+    template<typename ... Columns>
+    constexpr std::size_t UnitFrame<Columns...>::ColumnCount;
+
+    /// @brief Column<ResultI> = Column<LhsI> * Column<RhsI>, e.g. P = V * I
+    ///
+    template<typename ValueSys, std::size_t ResultI, std::size_t LhsI, std::size_t RhsI, typename ... Columns>
+    void DeriveProduct(UnitFrame<Columns...> &frame) {
+        UnitMultBatch<ValueSys>(frame.template Column<LhsI>(), frame.template Column<RhsI>(),
+                                frame.template Column<ResultI>());
+    }
+
+    /// @brief Column<ResultI> = cumulative integral of Column<InI> over the time in Column<TimeI>
+    ///
+    template<typename ValueSys, std::size_t ResultI, std::size_t InI, std::size_t TimeI, typename ... Columns>
+    void DeriveIntegral(UnitFrame<Columns...> &frame) {
+        IntegrateBatch<ValueSys>(frame.template Column<InI>(), frame.template Column<TimeI>(),
+                                 frame.template Column<ResultI>());
+    }
+
+    /// @brief Column<PowerI> = Column<VoltI> * Column<CurrentI> and Column<EnergyI> = integral of it over Column<TimeI>
+    ///
+    /// Fused variant of DeriveProduct and DeriveIntegral, see PowerEnergyBatch.
+    ///
+    template<typename ValueSys, std::size_t PowerI, std::size_t EnergyI, std::size_t VoltI, std::size_t CurrentI,
+            std::size_t TimeI, typename ... Columns>
+    void DerivePowerAndEnergy(UnitFrame<Columns...> &frame) {
+        PowerEnergyBatch<ValueSys>(frame.template Column<VoltI>(), frame.template Column<CurrentI>(),
+                                   frame.template Column<TimeI>(), frame.template Column<PowerI>(),
+                                   frame.template Column<EnergyI>());
+    }
+}
@@ -0,0 +1,247 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "BitOps.hpp"
+#include "UnitSpan.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace LightUnits {
+    namespace detail {
+        /// Smallest number of bits which can distinguish 2 * 10^digits values
+        constexpr unsigned SubBucketBits(unsigned digits) {
+            std::uint64_t range = 2;
+            for (unsigned i = 0; i < digits; ++i) {
+                range *= 10;
+            }
+            unsigned bits = 0;
+            while ((std::uint64_t(1) << bits) < range) {
+                ++bits;
+            }
+            return bits;
+        }
+    }
+
+    /// @brief Log-linear histogram over the raw values of a unit (HdrHistogram layout)
+    ///
+    /// Values are bucketed by their magnitude in the unit's BasePrefix: each power of two is split into linear
+    /// sub-buckets, so every recorded value is kept with at least SignificantDigits decimal digits of precision.
+    /// Example: Second in us, 3 digits: 1234 us and 1235 us are distinguished, 1234567 us and 1235000 us are not.
+    ///
+    /// Negative values are kept in a mirrored set of buckets. The full range of ValueType is covered, there is
+    /// no need to configure a maximum. Memory: 2 * (bits(ValueType) - S + 2) * 2^(S-1) counters with
+    /// S = ceil(log2(2 * 10^SignificantDigits)), e.g. 376 KiB for 32 bit values and 3 digits.
+    ///
+    /// Recording is O(1) without data-dependent branches. Instances are not thread-safe; use one per thread
+    /// and combine them by Merge().
+    ///
+    template<typename Unit, unsigned SignificantDigits = 3>
+    class UnitHistogram {
+        static_assert(SignificantDigits >= 1 && SignificantDigits <= 5, "Supported are 1 to 5 significant digits");
+
+    public:
+        using ValueType = typename Unit::ValueType;
+        using CountType = std::uint64_t;
+
+        UnitHistogram()
+                : m_counts(2 * BucketsPerSign, 0) {
+        }
+
+        void Record(Unit const &value) {
+            RecordRaw(value.template To<Unit::BasePrefix>(), 1);
+        }
+
+        void Record(Unit const &value, CountType count) {
+            RecordRaw(value.template To<Unit::BasePrefix>(), count);
+        }
+
+        template<typename UnitElem>
+        void Record(UnitSpan<UnitElem> values) {
+            for (auto const &value : values) {
+                RecordRaw(value.template To<Unit::BasePrefix>(), 1);
+            }
+        }
+
+        /// Adds all samples of other, e.g. to combine per-thread histograms
+        void Merge(UnitHistogram const &other) {
+            for (std::size_t i = 0; i < m_counts.size(); ++i) {
+                m_counts[i] += other.m_counts[i];
+            }
+            if (other.m_total != 0) {
+                m_min = m_total != 0 ? std::min(m_min, other.m_min) : other.m_min;
+                m_max = m_total != 0 ? std::max(m_max, other.m_max) : other.m_max;
+            }
+            m_total += other.m_total;
+        }
+
+        void Reset() {
+            std::fill(m_counts.begin(), m_counts.end(), 0);
+            m_total = 0;
+            m_min = std::numeric_limits<ValueType>::max();
+            m_max = std::numeric_limits<ValueType>::min();
+        }
+
+        CountType Count() const {
+            return m_total;
+        }
+
+        /// Exact smallest recorded value. Undefined for an empty histogram.
+        Unit Min() const {
+            return Unit::template From<Unit::BasePrefix>(m_min);
+        }
+
+        /// Exact largest recorded value. Undefined for an empty histogram.
+        Unit Max() const {
+            return Unit::template From<Unit::BasePrefix>(m_max);
+        }
+
+        /// @brief Smallest value v such that at least rank recorded samples are <= v, within the bucket precision
+        ///
+        /// The result is the highest value equivalent to the bucket holding the rank-th sample, limited to [Min, Max].
+        /// rank is clamped to [1, Count()]. Returns 0 for an empty histogram.
+        ///
+        Unit ValueAtRank(CountType rank) const {
+            if (m_total == 0) {
+                return Unit::template From<Unit::BasePrefix>(0);
+            }
+            rank = std::max<CountType>(1, std::min(rank, m_total));
+
+            CountType seen = 0;
+            for (std::size_t i = BucketsPerSign; i-- > 0;) {
+                seen += m_counts[BucketsPerSign + i];
+                if (seen >= rank) {
+                    return NegativeBucketValue(i);
+                }
+            }
+            for (std::size_t i = 0; i < BucketsPerSign; ++i) {
+                seen += m_counts[i];
+                if (seen >= rank) {
+                    return PositiveBucketValue(i);
+                }
+            }
+            return Max();
+        }
+
+        /// @brief Value at quantile q in [0, 1], e.g. 0.99 for p99
+        ///
+        Unit ValueAtQuantile(double q) const {
+            if (q <= 0.0) {
+                return m_total == 0 ? Unit::template From<Unit::BasePrefix>(0) : Min();
+            }
+            return ValueAtRank(RankOf(q));
+        }
+
+        /// @brief Values at several quantiles in a single pass over the buckets
+        ///
+        /// quantiles have to be sorted in ascending order, out has to have the same size.
+        ///
+        template<typename QuantileElem>
+        void ValuesAtQuantiles(UnitSpan<QuantileElem> quantiles, UnitSpan<Unit> out) const {
+            assert(quantiles.size() == out.size());
+
+            std::size_t q = 0;
+            for (; q < quantiles.size() && (quantiles[q] <= 0.0 || m_total == 0); ++q) {
+                out[q] = ValueAtQuantile(quantiles[q]);
+            }
+
+            CountType seen = 0;
+            for (std::size_t n = 0; n < 2 * BucketsPerSign && q < quantiles.size(); ++n) {
+                bool const negative = n < BucketsPerSign;
+                std::size_t const i = negative ? BucketsPerSign - 1 - n : n - BucketsPerSign;
+                seen += m_counts[negative ? BucketsPerSign + i : i];
+
+                for (; q < quantiles.size() && seen >= RankOf(quantiles[q]); ++q) {
+                    out[q] = negative ? NegativeBucketValue(i) : PositiveBucketValue(i);
+                }
+            }
+        }
+
+    private:
+        using Magnitude = typename std::make_unsigned<ValueType>::type;
+
+        static constexpr unsigned SubBits = detail::SubBucketBits(SignificantDigits);
+        static constexpr unsigned HalfBits = SubBits - 1;
+        static constexpr std::uint64_t HalfCount = std::uint64_t(1) << HalfBits;
+        static constexpr std::uint64_t SubMask = (std::uint64_t(1) << SubBits) - 1;
+        static constexpr unsigned ValueBits = std::numeric_limits<Magnitude>::digits;
+        static constexpr std::size_t BucketsPerSign =
+                ((ValueBits > SubBits ? ValueBits : SubBits) - SubBits + 2) * HalfCount;
+
+        static std::size_t IndexOf(Magnitude magnitude) {
+            std::uint64_t const val = magnitude;
+            int const bucket = 64 - detail::CountLeadingZeros(val | SubMask) - static_cast<int>(SubBits);
+            std::uint64_t const subBucket = val >> bucket;
+            return static_cast<std::size_t>((std::uint64_t(bucket + 1) << HalfBits) + (subBucket - HalfCount));
+        }
+
+        static int BucketOf(std::size_t index) {
+            int const bucket = static_cast<int>(index >> HalfBits) - 1;
+            return bucket < 0 ? 0 : bucket;
+        }
+
+        static std::uint64_t LowestOf(std::size_t index) {
+            std::uint64_t subBucket = (index & (HalfCount - 1)) + HalfCount;
+            if ((index >> HalfBits) == 0) {
+                subBucket -= HalfCount;
+            }
+            return subBucket << BucketOf(index);
+        }
+
+        static std::uint64_t SizeOf(std::size_t index) {
+            return std::uint64_t(1) << BucketOf(index);
+        }
+
+        CountType RankOf(double q) const {
+            double const exact = q * static_cast<double>(m_total);
+            auto rank = static_cast<CountType>(exact);
+            rank += (static_cast<double>(rank) < exact) ? 1 : 0;
+            return std::max<CountType>(1, std::min(rank, m_total));
+        }
+
+        /// Highest value of a bucket holding samples, limited to Max().
+        /// As the bucket holds at least one sample, the result is never below Min() and always representable.
+        Unit PositiveBucketValue(std::size_t index) const {
+            std::uint64_t const highest = std::min<std::uint64_t>(LowestOf(index) + SizeOf(index) - 1,
+                                                                  static_cast<std::uint64_t>(m_max));
+            return Unit::template From<Unit::BasePrefix>(static_cast<ValueType>(highest));
+        }
+
+        Unit NegativeBucketValue(std::size_t index) const {
+            auto const highest = static_cast<std::int64_t>(std::uint64_t(0) - LowestOf(index));
+            return Unit::template From<Unit::BasePrefix>(
+                    static_cast<ValueType>(std::min<std::int64_t>(highest, m_max)));
+        }
+
+        void RecordRaw(ValueType raw, CountType count) {
+            std::size_t const sign = raw < 0 ? 1u : 0u;
+            m_counts[IndexOf(detail::UnsignedAbs(raw)) + sign * BucketsPerSign] += count;
+            m_total += count;
+            m_min = std::min(m_min, raw);
+            m_max = std::max(m_max, raw);
+        }
+
+        std::vector<CountType> m_counts;
+        CountType m_total = 0;
+        ValueType m_min = std::numeric_limits<ValueType>::max();
+        ValueType m_max = std::numeric_limits<ValueType>::min();
+    };
+}
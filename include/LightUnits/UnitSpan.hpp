@@ -0,0 +1,118 @@
+/*  Copyright 2018 Daniel Penning
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace LightUnits {
+    /// @brief Non-owning view onto a contiguous sequence of units
+    ///
+    /// Batch kernels take their inputs as UnitSpan<Unit const> and write their results into a UnitSpan<Unit>.
+    /// Modelled after std::span (C++20), reduced to what is needed here. No bounds are checked.
+    ///
+    template<typename Unit>
+    class UnitSpan {
+    public:
+        using element_type = Unit;
+        using value_type = typename std::remove_cv<Unit>::type;
+        using size_type = std::size_t;
+        using pointer = Unit *;
+        using reference = Unit &;
+        using iterator = Unit *;
+
+        constexpr UnitSpan()
+                : m_data(nullptr), m_size(0) {
+        }
+
+        constexpr UnitSpan(pointer data, size_type size)
+                : m_data(data), m_size(size) {
+        }
+
+        template<std::size_t N>
+        constexpr UnitSpan(Unit (&array)[N])
+                : m_data(array), m_size(N) {
+        }
+
+        /// Allows UnitSpan<Unit> to be passed where UnitSpan<Unit const> is expected
+        template<typename Other, typename = typename std::enable_if<
+                std::is_convertible<Other (*)[], Unit (*)[]>::value>::type>
+        constexpr UnitSpan(UnitSpan<Other> const &other)
+                : m_data(other.data()), m_size(other.size()) {
+        }
+
+        /// Views any contiguous container providing data() and size(), e.g. std::vector or std::array
+        template<typename Container, typename = typename std::enable_if<
+                !std::is_base_of<UnitSpan, typename std::decay<Container>::type>::value &&
+                std::is_convertible<decltype(std::declval<Container &>().data()), pointer>::value>::type>
+        constexpr UnitSpan(Container &container)
+                : m_data(container.data()), m_size(container.size()) {
+        }
+
+        constexpr pointer data() const {
+            return m_data;
+        }
+
+        constexpr size_type size() const {
+            return m_size;
+        }
+
+        constexpr bool empty() const {
+            return m_size == 0;
+        }
+
+        constexpr reference operator[](size_type index) const {
+            return m_data[index];
+        }
+
+        constexpr iterator begin() const {
+            return m_data;
+        }
+
+        constexpr iterator end() const {
+            return m_data + m_size;
+        }
+
+        constexpr UnitSpan first(size_type count) const {
+            return UnitSpan(m_data, count);
+        }
+
+        constexpr UnitSpan subspan(size_type offset, size_type count) const {
+            return UnitSpan(m_data + offset, count);
+        }
+
+        constexpr UnitSpan subspan(size_type offset) const {
+            return UnitSpan(m_data + offset, m_size - offset);
+        }
+
+    private:
+        pointer m_data;
+        size_type m_size;
+    };
+
+    /// @brief Creates a span over a container while deducing the element type
+    ///
+    template<typename Container>
+    constexpr auto MakeSpan(Container &container) -> UnitSpan<typename std::remove_pointer<decltype(container.data())>::type> {
+        return {container.data(), container.size()};
+    }
+
+    template<typename Unit>
+    constexpr UnitSpan<Unit> MakeSpan(Unit *data, std::size_t size) {
+        return {data, size};
+    }
+}
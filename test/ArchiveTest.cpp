@@ -0,0 +1,209 @@
+#include <catch.hpp>
+#include <IntegralUnits/Conversions.hpp>
+#include <LightUnits/Archive.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <unistd.h>
+
+using namespace LightUnits;
+
+using Writer = ArchiveWriter<Second, Volt, Ampere>;
+using Reader = ArchiveReader<Second, Volt, Ampere>;
+
+/// Unique file in the temp directory, removed at the end of the test
+class TempArchive {
+public:
+    TempArchive()
+            : m_path("/tmp/LightUnitsArchiveXXXXXX") {
+        int const fd = ::mkstemp(&m_path[0]);
+        ::close(fd);
+        std::remove(m_path.c_str());
+    }
+
+    ~TempArchive() {
+        std::remove(m_path.c_str());
+    }
+
+    std::string const &Path() const {
+        return m_path;
+    }
+
+private:
+    std::string m_path;
+};
+
+/// Row i at i ms with i mV and -i mA
+static void WriteRows(std::string const &path, int begin, int end, std::size_t chunkRows)
+{
+    Writer writer(path, chunkRows);
+    for (int i = begin; i < end; ++i) {
+        writer.AppendRow(i * 1_ms, i * 1_mV, i * -1_mA);
+    }
+}
+
+TEST_CASE("Archive_RoundTripsColumnsWithoutCopy")
+{
+    TempArchive file;
+    WriteRows(file.Path(), 0, 250, 100);
+
+    Reader reader(file.Path());
+    REQUIRE(reader.Chunks() == 3);
+    REQUIRE(reader.Rows() == 250);
+    REQUIRE(reader.ChunkRows(2) == 50);
+
+    auto const volts = reader.Column<1>(1);
+    REQUIRE(volts.size() == 100);
+    REQUIRE(volts[0] == 100_mV);
+    REQUIRE(reader.Column<2>(2)[49] == -249_mA);
+    REQUIRE(reader.Column<0>(2)[49] == 249_ms);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(volts.data()) % alignof(Volt) == 0);
+}
+
+TEST_CASE("Archive_StoresChunkSummaries")
+{
+    TempArchive file;
+    WriteRows(file.Path(), 0, 200, 100);
+
+    Reader reader(file.Path());
+    auto const summary = reader.Summary<1>(1);
+    REQUIRE(summary.min == 100_mV);
+    REQUIRE(summary.max == 199_mV);
+    REQUIRE(summary.rawSum.Low() == 14950);
+    REQUIRE(summary.rawSum.High() == 0);
+    REQUIRE(summary.rows == 100);
+    REQUIRE(summary.Mean() == 149_mV);
+}
+
+TEST_CASE("Archive_QueryReturnsTimeRange")
+{
+    TempArchive file;
+    WriteRows(file.Path(), 0, 1000, 64);
+
+    Reader reader(file.Path());
+    auto const slices = reader.Query(100_ms, 199_ms);
+
+    std::size_t rows = 0;
+    for (auto const &slice : slices) {
+        for (auto const t : reader.Column<0>(slice)) {
+            REQUIRE(t >= 100_ms);
+            REQUIRE(t <= 199_ms);
+        }
+        rows += slice.end - slice.begin;
+    }
+    REQUIRE(rows == 100);
+    REQUIRE(reader.Column<0>(slices.front())[0] == 100_ms);
+
+    REQUIRE(reader.Query(5_s, 6_s).empty());
+    REQUIRE(reader.Query(-2_s, -1_s).empty());
+}
+
+TEST_CASE("Archive_AggregateExactAndCoarse")
+{
+    TempArchive file;
+    WriteRows(file.Path(), 0, 1000, 64);
+
+    Reader reader(file.Path());
+
+    auto const exact = reader.Aggregate<1>(100_ms, 199_ms);
+    REQUIRE(exact.rows == 100);
+    REQUIRE(exact.min == 100_mV);
+    REQUIRE(exact.max == 199_mV);
+    REQUIRE(exact.rawSum.Low() == 14950);
+
+    // Chunks of 64 rows: [64, 127] ... [192, 255]
+    auto const coarse = reader.CoarseAggregate<1>(100_ms, 199_ms);
+    REQUIRE(coarse.rows == 192);
+    REQUIRE(coarse.min == 64_mV);
+    REQUIRE(coarse.max == 255_mV);
+
+    auto const current = reader.Aggregate<2>(0_ms, 10_s);
+    REQUIRE(current.rows == 1000);
+    REQUIRE(current.min == -999_mA);
+
+    REQUIRE(reader.Aggregate<1>(2_s, 3_s).rows == 0);
+}
+
+TEST_CASE("Archive_ReopenAppendsAndDiscardsUncommitted")
+{
+    TempArchive file;
+    WriteRows(file.Path(), 0, 100, 64);
+
+    // Simulate a crash while writing the next chunk: bytes past the committed chunks
+    {
+        FILE *f = std::fopen(file.Path().c_str(), "ab");
+        std::fputs("torn chunk", f);
+        std::fclose(f);
+    }
+    REQUIRE(Reader(file.Path()).Chunks() == 2);
+
+    // Chunk size of the file wins
+    WriteRows(file.Path(), 100, 200, 10);
+
+    Reader reader(file.Path());
+    REQUIRE(reader.Rows() == 200);
+    REQUIRE(reader.Chunks() == 4);
+    REQUIRE(reader.Column<1>(3)[35] == 199_mV);
+}
+
+struct SecondNano64
+{
+    static LightUnits::Prefix const BasePrefix = LightUnits::Prefix::Nano;
+    typedef std::int64_t ValueType;
+};
+
+using Timestamp = LightUnits::BaseUnit<LightUnits::Second_t, SecondNano64>;
+
+TEST_CASE("Archive_SummariesOfInt64Timestamps")
+{
+    // Nanoseconds since the epoch: the sum of three timestamps already exceeds int64
+    std::int64_t const epoch = 1700000000000000000LL;
+
+    TempArchive file;
+    {
+        ArchiveWriter<Timestamp, Volt> writer(file.Path(), 100);
+        for (int i = 0; i < 250; ++i) {
+            writer.AppendRow(Timestamp::From<Prefix::Nano>(epoch + i * 1000LL), i * 1_mV);
+        }
+    }
+
+    ArchiveReader<Timestamp, Volt> reader(file.Path());
+    auto const chunk = reader.Summary<0>(1);
+    REQUIRE(chunk.rows == 100);
+    REQUIRE(chunk.rawSum.High() > 0);
+    REQUIRE(chunk.Mean() == Timestamp::From<Prefix::Nano>(epoch + 149500));
+
+    auto const last = Timestamp::From<Prefix::Nano>(epoch + 249000);
+    auto const all = reader.CoarseAggregate<0>(Timestamp::From<Prefix::Nano>(epoch), last);
+    REQUIRE(all.rows == 250);
+    REQUIRE(all.Mean() == Timestamp::From<Prefix::Nano>(epoch + 124500));
+
+    auto const exact = reader.Aggregate<0>(Timestamp::From<Prefix::Nano>(epoch + 50000), last);
+    REQUIRE(exact.rows == 200);
+    REQUIRE(exact.Mean() == Timestamp::From<Prefix::Nano>(epoch + 149500));
+    REQUIRE(exact.min == Timestamp::From<Prefix::Nano>(epoch + 50000));
+    REQUIRE(exact.max == last);
+}
+
+TEST_CASE("Archive_RejectsRowsOutOfTimeOrder")
+{
+    TempArchive file;
+    Writer writer(file.Path(), 64);
+    writer.AppendRow(5_ms, 1_mV, 1_mA);
+    writer.AppendRow(5_ms, 2_mV, 2_mA);
+    REQUIRE_THROWS_AS(writer.AppendRow(4_ms, 3_mV, 3_mA), std::invalid_argument);
+    REQUIRE(writer.BufferedRows() == 2);
+    writer.AppendRow(6_ms, 4_mV, 4_mA);
+    REQUIRE(writer.BufferedRows() == 3);
+}
+
+TEST_CASE("Archive_RejectsMismatchingColumns")
+{
+    TempArchive file;
+    WriteRows(file.Path(), 0, 10, 64);
+
+    using Other = ArchiveReader<Second, Volt, Volt>;
+    REQUIRE_THROWS_AS(Other(file.Path()), std::runtime_error);
+    REQUIRE_THROWS_AS(Reader(file.Path() + ".missing"), std::system_error);
+}
@@ -0,0 +1,157 @@
+#include <catch.hpp>
+#include <IntegralUnits/Second.hpp>
+#include <LightUnits/Chrono.hpp>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <ratio>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+using namespace LightUnits;
+using namespace std::chrono;
+
+static_assert(std::is_same<NativeDuration<Second>, duration<int, std::micro>>::value, "");
+static_assert(FromDuration<Second>(milliseconds(3)) == 3_ms, "Conversions have to be usable in constant expressions");
+static_assert(ToDuration<milliseconds>(3_ms) == milliseconds(3), "");
+
+TEST_CASE("FromDuration_DecimalPeriods")
+{
+    REQUIRE(FromDuration<Second>(seconds(2)) == 2_s);
+    REQUIRE(FromDuration<Second>(milliseconds(-15)) == -15_ms);
+    REQUIRE(FromDuration<Second>(microseconds(7)) == 7_us);
+    REQUIRE(FromDuration<Second>(duration<int, std::micro>(7)) == 7_us);
+}
+
+TEST_CASE("FromDuration_FinerPeriodIsTruncated")
+{
+    REQUIRE(FromDuration<Second>(nanoseconds(1999)) == 1_us);
+    REQUIRE(FromDuration<Second>(nanoseconds(-1999)) == -1_us);
+}
+
+TEST_CASE("FromDuration_NonDecimalPeriods")
+{
+    REQUIRE(FromDuration<Second>(minutes(2)) == 120_s);
+    REQUIRE(FromDuration<Second>(duration<long long, std::ratio<1, 3>>(10)) == 3333333_us);
+}
+
+TEST_CASE("ToDuration_DecimalPeriods")
+{
+    REQUIRE(ToDuration<nanoseconds>(3_us) == nanoseconds(3000));
+    REQUIRE(ToDuration<milliseconds>(1999_us) == milliseconds(1));
+    REQUIRE(ToDuration<seconds>(-2_s) == seconds(-2));
+}
+
+TEST_CASE("ToDuration_NativeDurationKeepsRawValue")
+{
+    auto const d = ToDuration(1234_us);
+    static_assert(std::is_same<decltype(d), NativeDuration<Second> const>::value, "");
+    REQUIRE(d.count() == 1234);
+    REQUIRE(FromDuration<Second>(d) == 1234_us);
+}
+
+TEST_CASE("FromDurationBatch_MatchesScalar")
+{
+    std::vector<nanoseconds> const in = {nanoseconds(0), nanoseconds(1000), nanoseconds(2500000), nanoseconds(-3000)};
+    std::vector<Second> out(in.size());
+
+    FromDurationBatch(MakeSpan(in), MakeSpan(out));
+
+    REQUIRE(out[0] == 0_us);
+    REQUIRE(out[1] == 1_us);
+    REQUIRE(out[2] == 2500_us);
+    REQUIRE(out[3] == -3_us);
+}
+
+TEST_CASE("FromTimePoints_RelativeToOrigin")
+{
+    auto const origin = steady_clock::now();
+    std::vector<steady_clock::time_point> const timestamps = {
+            origin, origin + microseconds(10), origin + milliseconds(5), origin + seconds(1)
+    };
+
+    auto const times = FromTimePoints<Second>(MakeSpan(timestamps), origin);
+
+    REQUIRE(times.size() == 4);
+    REQUIRE(times[0] == 0_s);
+    REQUIRE(times[1] == 10_us);
+    REQUIRE(times[2] == 5_ms);
+    REQUIRE(times[3] == 1_s);
+}
+
+struct SecondMicroSaturating
+{
+    static LightUnits::Prefix const BasePrefix = LightUnits::Prefix::Micro;
+    typedef std::int32_t ValueType;
+    typedef SaturateOverflow OverflowPolicy;
+};
+
+struct SecondMicroTrapping
+{
+    static LightUnits::Prefix const BasePrefix = LightUnits::Prefix::Micro;
+    typedef std::int32_t ValueType;
+    typedef TrapOverflow OverflowPolicy;
+};
+
+using SecondSat = LightUnits::BaseUnit<LightUnits::Second_t, SecondMicroSaturating>;
+using SecondTrap = LightUnits::BaseUnit<LightUnits::Second_t, SecondMicroTrapping>;
+
+static void ThrowOnChronoOverflow(char const *operation)
+{
+    throw std::overflow_error(operation);
+}
+
+TEST_CASE("FromDuration_FloatingPointIsTruncated")
+{
+    REQUIRE(FromDuration<SecondSat>(duration<double, std::milli>(1.5)) == SecondSat::From<Prefix::Micro>(1500));
+    REQUIRE(FromDuration<SecondSat>(duration<double, std::micro>(2.7)) == SecondSat::From<Prefix::Micro>(2));
+    REQUIRE(FromDuration<SecondSat>(duration<float, std::micro>(-2.7f)) == SecondSat::From<Prefix::Micro>(-2));
+    REQUIRE(FromDuration<Second>(duration<double>(0.25)) == 250_ms);
+
+    REQUIRE(FromDuration<SecondSat>(duration<double>(1e10)) == std::numeric_limits<SecondSat>::max());
+    REQUIRE(FromDuration<SecondSat>(duration<double>(-1e10)) == std::numeric_limits<SecondSat>::min());
+    REQUIRE(FromDuration<SecondSat>(duration<double>(std::numeric_limits<double>::quiet_NaN()))
+            == SecondSat::From<Prefix::Micro>(0));
+}
+
+TEST_CASE("FromDuration_OverflowFollowsPolicy")
+{
+    auto const max = std::numeric_limits<SecondSat>::max();
+    auto const min = std::numeric_limits<SecondSat>::min();
+    // In range of int64 before the narrowing
+    REQUIRE(FromDuration<SecondSat>(seconds(3000)) == max);
+    REQUIRE(FromDuration<SecondSat>(seconds(-3000)) == min);
+    // The multiplication by 10^6 overflows int64 already
+    long long const huge = std::numeric_limits<long long>::max() / 1000;
+    REQUIRE(FromDuration<SecondSat>(duration<long long>(huge)) == max);
+    REQUIRE(FromDuration<SecondSat>(duration<long long>(-huge)) == min);
+
+    OverflowTrapHandler const previous = SetOverflowTrapHandler(&ThrowOnChronoOverflow);
+    REQUIRE_THROWS_AS(FromDuration<SecondTrap>(duration<long long>(huge)), std::overflow_error);
+    REQUIRE_THROWS_AS(FromDuration<SecondTrap>(seconds(3000)), std::overflow_error);
+    REQUIRE_THROWS_AS(FromDuration<SecondTrap>(duration<double>(1e10)), std::overflow_error);
+    REQUIRE(FromDuration<SecondTrap>(seconds(2000)) == SecondTrap::From<Prefix::One>(2000));
+    SetOverflowTrapHandler(previous);
+}
+
+TEST_CASE("ToDuration_OverflowFollowsPolicy")
+{
+    auto const max = std::numeric_limits<SecondSat>::max();
+    auto const min = std::numeric_limits<SecondSat>::min();
+    // Multiplication by 1000 in int
+    REQUIRE(ToDuration<duration<int, std::nano>>(max) == duration<int, std::nano>(std::numeric_limits<int>::max()));
+    REQUIRE(ToDuration<duration<int, std::nano>>(min) == duration<int, std::nano>(std::numeric_limits<int>::min()));
+    // Narrowing into short
+    REQUIRE(ToDuration<duration<short, std::milli>>(SecondSat::From<Prefix::One>(40)).count() == 32767);
+    REQUIRE(ToDuration<duration<short, std::milli>>(SecondSat::From<Prefix::One>(-40)).count() == -32768);
+    REQUIRE(ToDuration<duration<double>>(SecondSat::From<Prefix::Micro>(1500)).count() == 0.0015);
+
+    OverflowTrapHandler const previous = SetOverflowTrapHandler(&ThrowOnChronoOverflow);
+    REQUIRE_THROWS_AS((ToDuration<duration<int, std::nano>>(std::numeric_limits<SecondTrap>::max())),
+                      std::overflow_error);
+    REQUIRE_THROWS_AS((ToDuration<duration<short, std::milli>>(SecondTrap::From<Prefix::One>(40))),
+                      std::overflow_error);
+    REQUIRE(ToDuration<nanoseconds>(std::numeric_limits<SecondTrap>::max()).count() == 2147483647000LL);
+    SetOverflowTrapHandler(previous);
+}
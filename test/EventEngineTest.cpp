@@ -0,0 +1,241 @@
+#include <catch.hpp>
+#include <IntegralUnits/Conversions.hpp>
+#include <LightUnits/EventEngine.hpp>
+#include <LightUnits/UnitArray.hpp>
+#include <random>
+#include <vector>
+
+using namespace LightUnits;
+
+/// Sample by sample evaluation of one limit, as reference for the engine
+template<typename Unit>
+static std::vector<UnitEvent<Unit>> ReferenceEvents(Limit<Unit> const &limit, UnitArray<Unit> const &samples)
+{
+    std::vector<UnitEvent<Unit>> events;
+    bool active = false;
+    unsigned run = 0;
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        Unit value = samples[i];
+        if (limit.Condition() == LimitCondition::SlewAbove) {
+            Unit const diff = samples[i] - samples[i == 0 ? 0 : i - 1];
+            value = diff < Unit::template From<Unit::BasePrefix>(0) ? -diff : diff;
+        }
+        bool const below = limit.Condition() == LimitCondition::Below;
+        bool const violated = below ? value < limit.Threshold() : value > limit.Threshold();
+        bool const released = below ? value >= limit.Release() : value <= limit.Release();
+
+        if (active) {
+            if (released) {
+                active = false;
+                events.push_back(UnitEvent<Unit>{i, 0, 0, EventKind::Cleared, value});
+            }
+            run = 0;
+        } else {
+            run = violated ? run + 1 : 0;
+            if (run == limit.Debounce()) {
+                active = true;
+                events.push_back(UnitEvent<Unit>{i, 0, 0, EventKind::Raised, value});
+            }
+        }
+    }
+    return events;
+}
+
+template<typename Unit>
+static std::vector<UnitEvent<Unit>> ProcessInBlocks(EventEngine<Unit> &engine, UnitArray<Unit> const &samples,
+                                                    std::vector<std::size_t> const &blocks)
+{
+    std::vector<UnitEvent<Unit>> events;
+    std::size_t done = 0;
+    for (std::size_t b = 0; done < samples.size(); ++b) {
+        std::size_t const size = std::min(blocks[b % blocks.size()], samples.size() - done);
+        engine.Process(samples.Span().subspan(done, size), events);
+        done += size;
+    }
+    return events;
+}
+
+template<typename Unit>
+static void RequireSameEvents(std::vector<UnitEvent<Unit>> const &actual, std::vector<UnitEvent<Unit>> const &expected)
+{
+    REQUIRE(actual.size() == expected.size());
+    for (std::size_t i = 0; i < actual.size(); ++i) {
+        REQUIRE(actual[i].index == expected[i].index);
+        REQUIRE(actual[i].kind == expected[i].kind);
+        REQUIRE(actual[i].value == expected[i].value);
+    }
+}
+
+TEST_CASE("EventEngine_OvercurrentWithDebounce")
+{
+    EventEngine<Ampere> engine(7);
+    auto const limit = engine.Add(Above(5_A).For(3));
+
+    UnitArray<Ampere> samples(10);
+    std::fill(samples.begin(), samples.end(), 1_A);
+    samples[1] = 6_A;   // Too short
+    samples[2] = 6_A;
+    samples[4] = 5_A;   // Not above
+    samples[5] = 6_A;
+    samples[6] = 7_A;
+    samples[7] = 8_A;
+
+    std::vector<EventEngine<Ampere>::Event> events;
+    engine.Process(samples.Span(), events);
+
+    REQUIRE(events.size() == 2);
+    REQUIRE(events[0].index == 7);
+    REQUIRE(events[0].channel == 7);
+    REQUIRE(events[0].limit == limit);
+    REQUIRE(events[0].kind == EventKind::Raised);
+    REQUIRE(events[0].value == 8_A);
+    REQUIRE(events[1].index == 8);
+    REQUIRE(events[1].kind == EventKind::Cleared);
+    REQUIRE(events[1].value == 1_A);
+    REQUIRE_FALSE(engine.Active(limit));
+}
+
+TEST_CASE("EventEngine_UndervoltageWithHysteresis")
+{
+    EventEngine<Volt> engine;
+    engine.Add(Below(200_V).Hysteresis(5_V));
+
+    UnitArray<Volt> samples(6);
+    samples[0] = 230_V;
+    samples[1] = 199_V;     // Raised
+    samples[2] = 203_V;     // Within hysteresis, stays active
+    samples[3] = 204999_mV;
+    samples[4] = 205_V;     // Cleared
+    samples[5] = 201_V;
+
+    std::vector<EventEngine<Volt>::Event> events;
+    engine.Process(samples.Span(), events);
+
+    REQUIRE(events.size() == 2);
+    REQUIRE(events[0].index == 1);
+    REQUIRE(events[0].kind == EventKind::Raised);
+    REQUIRE(events[1].index == 4);
+    REQUIRE(events[1].kind == EventKind::Cleared);
+}
+
+TEST_CASE("EventEngine_SlewAcrossBuffers")
+{
+    EventEngine<Volt> engine;
+    auto const slew = engine.Add(SlewAbove(50_mV));
+
+    UnitArray<Volt> first(3);
+    first[0] = 1000_mV;
+    first[1] = 1040_mV;
+    first[2] = 1080_mV;
+    UnitArray<Volt> second(2);
+    second[0] = 1020_mV;   // |dV| = 60 mV to the last sample of the previous buffer
+    second[1] = 1030_mV;
+
+    std::vector<EventEngine<Volt>::Event> events;
+    engine.Process(first.Span(), events);
+    REQUIRE(events.empty());
+    engine.Process(second.Span(), events);
+
+    REQUIRE(events.size() == 2);
+    REQUIRE(events[0].index == 3);
+    REQUIRE(events[0].limit == slew);
+    REQUIRE(events[0].value == 60_mV);
+    REQUIRE(events[1].index == 4);
+    REQUIRE(events[1].kind == EventKind::Cleared);
+}
+
+TEST_CASE("EventEngine_SlewSaturatesAtExtremes")
+{
+    EventEngine<Volt> engine;
+    engine.Add(SlewAbove(1_V));
+
+    UnitArray<Volt> samples(2);
+    samples[0] = Volt::From<Prefix::Milli>(std::numeric_limits<std::int32_t>::max());
+    samples[1] = Volt::From<Prefix::Milli>(std::numeric_limits<std::int32_t>::min());
+
+    std::vector<EventEngine<Volt>::Event> events;
+    engine.Process(samples.Span(), events);
+
+    REQUIRE(events.size() == 1);
+    REQUIRE(events[0].value == Volt::From<Prefix::Milli>(std::numeric_limits<std::int32_t>::max()));
+}
+
+TEST_CASE("EventEngine_MatchesReferenceForAnyBlocking")
+{
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> dist(-3000000, 3000000);
+    UnitArray<Ampere> samples(5000);
+    // Random walk for runs of violations and releases of varying length
+    int current = 0;
+    for (auto &sample : samples) {
+        current = std::max(-6000000, std::min(6000000, current + dist(rng) / 4));
+        sample = Ampere::From<Prefix::Micro>(current);
+    }
+
+    std::vector<Limit<Ampere>> const limits{
+            Above(2_A),
+            Above(2_A).For(5),
+            Above(1_A).For(70).Hysteresis(3_A),
+            Below(-1_A).Hysteresis(500_mA),
+            Below(-2_A).For(2),
+            SlewAbove(600_mA).For(2).Hysteresis(100_mA)
+    };
+    std::vector<std::vector<std::size_t>> const blockings{{5000}, {1}, {3, 64, 17}, {63, 65}};
+
+    for (auto const &limit : limits) {
+        auto const expected = ReferenceEvents(limit, samples);
+        REQUIRE(expected.size() > 4);
+        for (auto const &blocks : blockings) {
+            EventEngine<Ampere> engine;
+            engine.Add(limit);
+            RequireSameEvents(ProcessInBlocks(engine, samples, blocks), expected);
+        }
+    }
+}
+
+TEST_CASE("EventEngine_SeveralLimitsAndReset")
+{
+    EventEngine<Ampere> engine(2);
+    auto const over = engine.Add(Above(5_A));
+    auto const under = engine.Add(Below(-5_A));
+
+    UnitArray<Ampere> samples(4);
+    samples[0] = 6_A;
+    samples[1] = -6_A;
+    samples[2] = 0_A;
+    samples[3] = 6_A;
+
+    std::vector<EventEngine<Ampere>::Event> events;
+    engine.Process(samples.Span().subspan(0, 2), events);
+    REQUIRE(events.size() == 3);
+    REQUIRE(engine.Active(under));
+    REQUIRE_FALSE(engine.Active(over));
+
+    engine.Reset();
+    REQUIRE_FALSE(engine.Active(under));
+    events.clear();
+    engine.Process(samples.Span().subspan(2), events);
+    REQUIRE(events.size() == 1);
+    REQUIRE(events[0].index == 1);
+    REQUIRE(events[0].limit == over);
+}
+
+TEST_CASE("EventEngine_ExactlyOneBlock")
+{
+    // count equals the block size, i.e. no scalar tail after the SIMD compares
+    EventEngine<Ampere> engine;
+    engine.Add(Above(5_A));
+
+    UnitArray<Ampere> samples(64);
+    std::fill(samples.begin(), samples.end(), 1_A);
+    samples[62] = 6_A;
+    samples[63] = 6_A;
+
+    std::vector<EventEngine<Ampere>::Event> events;
+    engine.Process(samples.Span(), events);
+
+    REQUIRE(events.size() == 1);
+    REQUIRE(events[0].index == 62);
+    REQUIRE(events[0].kind == EventKind::Raised);
+    REQUIRE(engine.Active(0));
+}
@@ -42,3 +42,26 @@ TEST_CASE("Multiplication_Regression")
     REQUIRE(1_mV == 1_A * 1_mOhm);
     REQUIRE(10_mV == 1_uA * 10_kOhm);
 }
+
+TEST_CASE("Power_Regression")
+{
+    REQUIRE(1_W == 1_V * 1_A);
+    REQUIRE(6_W == 3_A * 2_V);
+    REQUIRE(1_mW == 1_mV * 1_A);
+    REQUIRE(5_mW == 5_V * 1_mA);
+
+    REQUIRE(6_W / 2_V == 3_A);
+    REQUIRE(6_W / 3_A == 2_V);
+    REQUIRE(1_mW / 1_V == 1_mA);
+}
+
+TEST_CASE("Energy_Regression")
+{
+    REQUIRE(1_J == 1_W * 1_s);
+    REQUIRE(3_mJ == 3_W * 1_ms);
+    REQUIRE(2_kJ == 1_s * 2_kW);
+
+    REQUIRE(10_J / 2_s == 5_W);
+    REQUIRE(10_J / 5_W == 2_s);
+    REQUIRE(1_mJ / 1_W == 1_ms);
+}
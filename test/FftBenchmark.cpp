@@ -0,0 +1,113 @@
+/// Accuracy and speed of HarmonicAnalyzer compared to a floating-point radix-2 FFT
+///
+/// Not part of the unit tests; run LightUnitsFftBenchmark from a release build.
+
+#include <IntegralUnits/Conversions.hpp>
+#include <LightUnits/Fft.hpp>
+#include <LightUnits/UnitArray.hpp>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace LightUnits;
+
+static double const Pi = std::acos(-1.0);
+
+/// Iterative in-place radix-2 FFT in single precision
+static void FloatFft(std::vector<std::complex<float>> &data)
+{
+    std::size_t const size = data.size();
+    for (std::size_t i = 1, j = 0; i < size; ++i) {
+        std::size_t bit = size >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(data[i], data[j]);
+        }
+    }
+    for (std::size_t half = 1; half < size; half <<= 1) {
+        for (std::size_t k = 0; k < half; ++k) {
+            auto const w = std::polar(1.0f, static_cast<float>(-Pi * k / half));
+            for (std::size_t group = 0; group < size; group += 2 * half) {
+                auto const t = data[group + k + half] * w;
+                data[group + k + half] = data[group + k] - t;
+                data[group + k] += t;
+            }
+        }
+    }
+}
+
+template<unsigned Log2Size>
+static void Run(double noiseAmplitude)
+{
+    constexpr std::size_t size = std::size_t(1) << Log2Size;
+    std::size_t const cycles = size / 128;
+    std::mt19937 rng(42);
+    std::normal_distribution<double> noise(0.0, noiseAmplitude);
+
+    // 230 V mains with 3rd, 5th and 7th harmonic, in mV
+    UnitArray<Volt> signal(size);
+    for (std::size_t n = 0; n < size; ++n) {
+        double const angle = 2 * Pi * cycles * n / size;
+        double const value = 325269.0 * std::sin(angle) + 16263.0 * std::sin(3 * angle + 0.2)
+                             + 9758.0 * std::sin(5 * angle + 0.4) + 3252.0 * std::sin(7 * angle) + noise(rng);
+        signal[n] = Volt::From<Prefix::Milli>(static_cast<int>(std::lround(value)));
+    }
+
+    std::size_t const repetitions = (1u << 22) / size;
+
+    HarmonicAnalyzer<Volt, Log2Size> analyzer;
+    UnitArray<Volt> amplitudes(analyzer.Bins);
+    auto const fixedStart = std::chrono::steady_clock::now();
+    for (std::size_t r = 0; r < repetitions; ++r) {
+        analyzer.Analyze(signal.Span());
+        analyzer.Amplitudes(amplitudes.Span());
+    }
+    auto const fixedEnd = std::chrono::steady_clock::now();
+
+    std::vector<std::complex<float>> spectrum(size);
+    std::vector<float> reference(analyzer.Bins);
+    auto const floatStart = std::chrono::steady_clock::now();
+    for (std::size_t r = 0; r < repetitions; ++r) {
+        for (std::size_t n = 0; n < size; ++n) {
+            spectrum[n] = signal[n].ToFloat();
+        }
+        FloatFft(spectrum);
+        for (std::size_t k = 0; k < reference.size(); ++k) {
+            reference[k] = std::abs(spectrum[k]) * ((k == 0 || k == size / 2) ? 1.0f : 2.0f) / size;
+        }
+    }
+    auto const floatEnd = std::chrono::steady_clock::now();
+
+    double errorEnergy = 0;
+    double signalEnergy = 0;
+    double maxError = 0;
+    for (std::size_t k = 0; k < reference.size(); ++k) {
+        double const error = amplitudes[k].ToFloat() - reference[k];
+        errorEnergy += error * error;
+        signalEnergy += static_cast<double>(reference[k]) * reference[k];
+        maxError = std::max(maxError, std::abs(error));
+    }
+
+    auto const perTransform = [repetitions](std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count() / repetitions;
+    };
+    std::printf("%6zu points, noise %6.0f mV: SNR %5.1f dB, max error %7.3f V, fixed %8.2f us, float %8.2f us\n",
+                size, noiseAmplitude, 10 * std::log10(signalEnergy / errorEnergy), maxError,
+                perTransform(fixedEnd - fixedStart), perTransform(floatEnd - floatStart));
+}
+
+int main()
+{
+    for (double noise : {0.0, 500.0}) {
+        Run<8>(noise);
+        Run<10>(noise);
+        Run<12>(noise);
+    }
+    return 0;
+}
@@ -0,0 +1,190 @@
+#include <catch.hpp>
+#include <IntegralUnits/Conversions.hpp>
+#include <LightUnits/Fft.hpp>
+#include <LightUnits/UnitArray.hpp>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace LightUnits;
+
+static double const Pi = std::acos(-1.0);
+
+/// Sum of sinusoids (bin, amplitude in mV) over size samples
+static UnitArray<Volt> Harmonics(std::size_t size, std::vector<std::pair<std::size_t, double>> const &components)
+{
+    UnitArray<Volt> signal(size);
+    for (std::size_t n = 0; n < size; ++n) {
+        double value = 0;
+        for (auto const &component : components) {
+            value += component.second * std::cos(2 * Pi * component.first * n / size + 0.3 * component.first);
+        }
+        signal[n] = Volt::From<Prefix::Milli>(static_cast<int>(std::lround(value)));
+    }
+    return signal;
+}
+
+/// Amplitudes in mV by a direct DFT in double precision
+static std::vector<double> ReferenceAmplitudes(UnitArray<Volt> const &signal)
+{
+    std::size_t const size = signal.size();
+    std::vector<double> amplitudes(size / 2 + 1);
+    for (std::size_t k = 0; k < amplitudes.size(); ++k) {
+        std::complex<double> sum = 0;
+        for (std::size_t n = 0; n < size; ++n) {
+            sum += static_cast<double>(signal[n].To<Prefix::Milli>()) * std::polar(1.0, -2 * Pi * k * n / size);
+        }
+        amplitudes[k] = std::abs(sum) * ((k == 0 || k == size / 2) ? 1.0 : 2.0) / size;
+    }
+    return amplitudes;
+}
+
+/// Exact Q15 value of x, limited to +-32767 as the twiddle factors
+static double Q15(double x)
+{
+    return std::max(-32767.0, std::min(32767.0, x * 32768));
+}
+
+TEST_CASE("Fft_ConstexprTwiddles")
+{
+    constexpr auto const &tables = FixedFft<10>::Tables;
+    static_assert(tables.cos[0] == 32767, "cos(0) saturates to the largest Q15 value");
+    static_assert(tables.bitReverse[1] == 512, "");
+
+    for (std::size_t half = 1; half < 1024; half <<= 1) {
+        for (std::size_t k = 0; k < half; ++k) {
+            double const angle = Pi * k / half;
+            REQUIRE(std::abs(tables.cos[half - 1 + k] - Q15(std::cos(angle))) <= 0.5);
+            REQUIRE(std::abs(tables.sin[half - 1 + k] - Q15(std::sin(angle))) <= 0.5);
+        }
+    }
+}
+
+TEST_CASE("Fft_SimdAndScalarAreBitIdentical")
+{
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    std::vector<ComplexQ15> simd(512);
+    for (auto &value : simd) {
+        value = ComplexQ15{static_cast<std::int16_t>(dist(rng)), static_cast<std::int16_t>(dist(rng))};
+    }
+    auto scalar = simd;
+
+    int const simdExponent = detail::FftTransform<9, true>(simd.data(), FixedFft<9>::Tables);
+    int const scalarExponent = detail::FftTransform<9, false>(scalar.data(), FixedFft<9>::Tables);
+
+    REQUIRE(simdExponent == scalarExponent);
+    for (std::size_t i = 0; i < simd.size(); ++i) {
+        REQUIRE(simd[i].re == scalar[i].re);
+        REQUIRE(simd[i].im == scalar[i].im);
+    }
+}
+
+TEST_CASE("Fft_SingleTone")
+{
+    auto const signal = Harmonics(256, {{5, 100000.0}});
+    HarmonicAnalyzer<Volt, 8> analyzer;
+    analyzer.Analyze(signal.Span());
+    UnitArray<Volt> amplitudes(analyzer.Bins);
+    analyzer.Amplitudes(amplitudes.Span());
+
+    REQUIRE(std::abs(amplitudes[5].To<Prefix::Milli>() - 100000) < 100);
+    for (std::size_t k = 0; k < amplitudes.size(); ++k) {
+        if (k != 5) {
+            REQUIRE(amplitudes[k].To<Prefix::Milli>() < 50);
+        }
+    }
+}
+
+TEST_CASE("Fft_HarmonicsMatchFloatingPoint")
+{
+    // 8 cycles of a 230 V mains voltage with 5 % third and 3 % fifth harmonic plus 200 mV offset
+    auto const signal = Harmonics(1024, {{0, 200.0}, {8, 325269.0}, {24, 16263.0}, {40, 9758.0}, {100, 150.0}});
+    auto const expected = ReferenceAmplitudes(signal);
+
+    HarmonicAnalyzer<Volt, 10> analyzer;
+    analyzer.Analyze(signal.Span());
+    UnitArray<Volt> amplitudes(analyzer.Bins);
+    analyzer.Amplitudes(amplitudes.Span());
+
+    // Errors below 0.05 % of the fundamental in every bin
+    for (std::size_t k = 0; k < amplitudes.size(); ++k) {
+        REQUIRE(std::abs(amplitudes[k].To<Prefix::Milli>() - expected[k]) < 160.0);
+    }
+    REQUIRE(std::abs(amplitudes[24].To<Prefix::Milli>() - 16263) < 160);
+}
+
+TEST_CASE("Fft_SmallSignalsAreNormalized")
+{
+    auto const signal = Harmonics(64, {{3, 5.0}});
+    HarmonicAnalyzer<Volt, 6> analyzer;
+    analyzer.Analyze(signal.Span());
+    UnitArray<Volt> amplitudes(analyzer.Bins);
+    analyzer.Amplitudes(amplitudes.Span());
+
+    REQUIRE(analyzer.Exponent() < 0);
+    REQUIRE(amplitudes[3] == 5_mV);
+}
+
+TEST_CASE("Fft_ZeroSignal")
+{
+    UnitArray<Volt> signal(16);
+    std::fill(signal.begin(), signal.end(), 0_V);
+    HarmonicAnalyzer<Volt, 4> analyzer;
+    analyzer.Analyze(signal.Span());
+    UnitArray<Volt> amplitudes(analyzer.Bins);
+    analyzer.Amplitudes(amplitudes.Span());
+    for (auto amplitude : amplitudes) {
+        REQUIRE(amplitude == 0_V);
+    }
+}
+
+TEST_CASE("Fft_LargestSupportedSize")
+{
+    // The constexpr tables of the largest size have to stay within the compiler's evaluation limits
+    using Fft = FixedFft<16>;
+    auto const &tables = Fft::Tables;
+    for (std::size_t half = 1; half < Fft::Size; half <<= 1) {
+        for (std::size_t k = 0; k < half; ++k) {
+            double const angle = Pi * k / half;
+            REQUIRE(std::abs(tables.cos[half - 1 + k] - Q15(std::cos(angle))) <= 0.5);
+            REQUIRE(std::abs(tables.sin[half - 1 + k] - Q15(std::sin(angle))) <= 0.5);
+        }
+    }
+    REQUIRE(tables.bitReverse[1] == 32768);
+    REQUIRE(tables.bitReverse[Fft::Size - 2] == 32767);
+
+    std::vector<ComplexQ15> data(Fft::Size);
+    for (std::size_t n = 0; n < data.size(); ++n) {
+        data[n].re = static_cast<std::int16_t>(std::lround(10000 * std::cos(2 * Pi * 1000 * n / Fft::Size)));
+    }
+    int const exponent = Fft::Transform(data.data());
+
+    // |X[1000]| = 10000 * Size / 2, all other bins close to zero
+    double const expected = 10000.0 * Fft::Size / 2;
+    double const peak = std::ldexp(std::hypot(data[1000].re, data[1000].im), exponent);
+    REQUIRE(std::abs(peak - expected) < 0.01 * expected);
+    for (std::size_t k = 0; k < Fft::Size / 2; ++k) {
+        if (k != 1000) {
+            REQUIRE(std::ldexp(std::hypot(data[k].re, data[k].im), exponent) < 0.001 * expected);
+        }
+    }
+}
+
+TEST_CASE("Fft_LargestAnalyzer")
+{
+    // 384 KB of member buffers, Amplitudes() must not need the same again on the stack
+    auto analyzer = std::make_unique<HarmonicAnalyzer<Volt, 16>>();
+    auto const signal = Harmonics(analyzer->Size, {{50, 325269.0}, {150, 16263.0}});
+    analyzer->Analyze(signal.Span());
+
+    UnitArray<Volt> amplitudes(analyzer->Bins);
+    analyzer->Amplitudes(amplitudes.Span());
+    // 16 stages of rounding, the error stays below 0.05 % of the fundamental
+    REQUIRE(std::abs(amplitudes[50].ToFloat() - 325.269f) < 0.15f);
+    REQUIRE(std::abs(amplitudes[150].ToFloat() - 16.263f) < 0.15f);
+    REQUIRE(amplitudes[100].ToFloat() < 0.15f);
+}
@@ -0,0 +1,136 @@
+#include <catch.hpp>
+#include <IntegralUnits/Conversions.hpp>
+#include <IntegralUnits/IntegralRatio.hpp>
+#include <LightUnits/Instrumentation.hpp>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+using namespace LightUnits::instrumentation;
+
+static_assert(1_A + 1_A == 2_A, "Instrumented operations without events remain constant expressions");
+
+TEST_CASE("Instrumentation_NoEventsForRegularArithmetic")
+{
+    Reset();
+    auto x = 1_A + 2_mA - 3_mA;
+    x += 10_mA;
+    auto u = x * 2_Ohm;
+    auto i = 4_V / 2_Ohm;
+    (void)u;
+    (void)i;
+
+    auto const snapshot = TakeSnapshot();
+    REQUIRE(snapshot.Total(Event::Overflow) == 0);
+    REQUIRE(snapshot.Total(Event::Narrowing) == 0);
+    REQUIRE(snapshot.Total(Event::PrecisionLoss) == 0);
+}
+
+TEST_CASE("Instrumentation_AdditionOverflow")
+{
+    Reset();
+    auto x = std::numeric_limits<Ampere>::max();
+    x += 1_uA;
+    auto y = std::numeric_limits<Ampere>::max() + 1_uA;
+    auto z = -std::numeric_limits<Volt>::min();
+    (void)y;
+    (void)z;
+
+    auto const snapshot = TakeSnapshot();
+    REQUIRE(snapshot.Count<Ampere>(Operation::Add, Event::Overflow) == 2);
+    REQUIRE(snapshot.Count<Volt>(Operation::Negate, Event::Overflow) == 1);
+    REQUIRE(snapshot.Count<Volt>(Operation::Add, Event::Overflow) == 0);
+}
+
+TEST_CASE("Instrumentation_FromAndTo")
+{
+    Reset();
+    auto big = Ampere::From<Prefix::One>(3000);
+    auto fine = 1500_uA;
+    auto coarse = fine.To<Prefix::Milli>();
+    (void)big;
+    (void)coarse;
+
+    auto const snapshot = TakeSnapshot();
+    REQUIRE(snapshot.Count<Ampere>(Operation::From, Event::Overflow) == 1);
+    REQUIRE(snapshot.Count<Ampere>(Operation::To, Event::PrecisionLoss) == 1);
+}
+
+TEST_CASE("Instrumentation_LiteralNarrowing")
+{
+    Reset();
+    auto x = 5000000000_uA;
+    (void)x;
+
+    REQUIRE(TakeSnapshot().Count<Ampere>(Operation::Literal, Event::Narrowing) == 1);
+}
+
+TEST_CASE("Instrumentation_FromFloat")
+{
+    Reset();
+    auto tooLarge = Ampere::FromFloat(1.0e6f);
+    auto tooFine = Ampere::FromFloat(0.0000015f);
+    (void)tooLarge;
+    (void)tooFine;
+
+    auto const snapshot = TakeSnapshot();
+    REQUIRE(snapshot.Count<Ampere>(Operation::FromFloat, Event::Overflow) == 1);
+    REQUIRE(snapshot.Count<Ampere>(Operation::FromFloat, Event::PrecisionLoss) == 1);
+}
+
+TEST_CASE("Instrumentation_UnitMultAndUnitDiv")
+{
+    Reset();
+    auto u = 2000_A * 2000_Ohm;
+    auto i = 1_mV / 3_Ohm;
+    (void)u;
+    (void)i;
+
+    auto const snapshot = TakeSnapshot();
+    REQUIRE(snapshot.Count<Volt>(Operation::UnitMult, Event::Narrowing) == 1);
+    REQUIRE(snapshot.Count<Ampere>(Operation::UnitDiv, Event::PrecisionLoss) == 1);
+    REQUIRE(snapshot.Count<Ampere>(Event::Narrowing) == 0);
+}
+
+TEST_CASE("Instrumentation_ApplyRatioNarrowing")
+{
+    Reset();
+    auto x = std::numeric_limits<Ampere>::max() * IntegralRatio::FromInteger(2);
+    (void)x;
+
+    REQUIRE(TakeSnapshot().Count<Ampere>(Operation::ApplyRatio, Event::Narrowing) == 1);
+}
+
+TEST_CASE("Instrumentation_AggregatesThreads")
+{
+    Reset();
+    auto overflow = [] {
+        for (int i = 0; i < 10; ++i) {
+            auto x = std::numeric_limits<Ohm>::max() + 1_mOhm;
+            (void)x;
+        }
+    };
+
+    std::thread first(overflow);
+    std::thread second(overflow);
+    first.join();
+    second.join();
+    overflow();
+
+    REQUIRE(TakeSnapshot().Count<Ohm>(Operation::Add, Event::Overflow) == 30);
+}
+
+TEST_CASE("Instrumentation_ExportCsv")
+{
+    Reset();
+    auto x = std::numeric_limits<Ohm>::max() + 1_mOhm;
+    (void)x;
+
+    std::ostringstream os;
+    TakeSnapshot().ExportCsv(os);
+
+    auto const csv = os.str();
+    REQUIRE(csv.find("unit;operation;event;count\n") == 0);
+    REQUIRE(csv.find(";Add;Overflow;1\n") != std::string::npos);
+    REQUIRE(csv.find("Ohm_t") != std::string::npos);
+}
@@ -0,0 +1,131 @@
+#include <catch.hpp>
+#include <IntegralUnits/Conversions.hpp>
+#include <LightUnits/Int128.hpp>
+#include <cstdint>
+#include <random>
+
+using namespace LightUnits;
+
+TEST_CASE("Int128_MulHigh")
+{
+    REQUIRE(detail::MulHigh(0, 12345) == 0);
+    REQUIRE(detail::MulHigh(std::uint64_t(1) << 32, std::uint64_t(1) << 32) == 1);
+    REQUIRE(detail::MulHigh(~std::uint64_t(0), ~std::uint64_t(0)) == ~std::uint64_t(0) - 1);
+    REQUIRE(detail::MulHigh(0x123456789ABCDEF0u, 0x0FEDCBA987654321u) == 0x121FA00AD77D742u);
+}
+
+#if defined(LIGHTUNITS_HAS_INT128)
+
+// Nanosecond timestamps: +-292 years
+struct SecondNano64 {
+    static Prefix const BasePrefix = Prefix::Nano;
+    typedef std::int64_t ValueType;
+};
+
+// Energy totals in uJ: +-9.2 TJ
+struct JouleMicro64 {
+    static Prefix const BasePrefix = Prefix::Micro;
+    typedef std::int64_t ValueType;
+};
+
+struct JouleMicro64Saturating {
+    static Prefix const BasePrefix = Prefix::Micro;
+    typedef std::int64_t ValueType;
+    typedef SaturateOverflow OverflowPolicy;
+};
+
+using Second64 = BaseUnit<Second_t, SecondNano64>;
+using Joule64 = BaseUnit<Joule_t, JouleMicro64>;
+using Joule64Sat = BaseUnit<Joule_t, JouleMicro64Saturating>;
+
+static Int128 Big(std::int64_t high, std::uint64_t low)
+{
+    return static_cast<Int128>((static_cast<UInt128>(static_cast<Int128>(high)) << 64) | low);
+}
+
+TEST_CASE("Int128_Limits")
+{
+    REQUIRE(detail::Limits<Int128>::max() == Big(0x7FFFFFFFFFFFFFFF, ~std::uint64_t(0)));
+    REQUIRE(detail::Limits<Int128>::min() == Big(std::numeric_limits<std::int64_t>::min(), 0));
+    REQUIRE(detail::Limits<UInt128>::max() == ~UInt128(0));
+    REQUIRE(detail::FitsInt64(std::numeric_limits<std::int64_t>::min()));
+    REQUIRE_FALSE(detail::FitsInt64(Int128(std::numeric_limits<std::int64_t>::max()) + 1));
+}
+
+TEST_CASE("Int128_UnitMultOfInt64Units")
+{
+    // 2 kW for 10^6 s: the product of the raw values (2e6 mW * 1e15 ns) exceeds the 64 bit range
+    auto const energy = UnitMult<IntegralValueSystem, Joule64>(2_kW, Second64::From<Prefix::Nano>(1000000000000000));
+    REQUIRE(energy == Joule64::From<Prefix::Micro>(2000000000000000));
+
+    auto const negative = UnitMult<IntegralValueSystem, Joule64>(
+            Watt::From<Prefix::Milli>(-1500), Second64::From<Prefix::Nano>(7000000000000001));
+    REQUIRE(negative == Joule64::From<Prefix::Micro>(-10500000000000));
+}
+
+TEST_CASE("Int128_UnitDivOfInt64Units")
+{
+    auto const power = UnitDiv<IntegralValueSystem, Watt>(Joule64::From<Prefix::Micro>(2000000000000000),
+                                                          Second64::From<Prefix::Nano>(1000000000000000));
+    REQUIRE(power == 2_kW);
+
+    auto const interval = UnitDiv<IntegralValueSystem, Second64>(Joule64::From<Prefix::Micro>(-5000000000000),
+                                                                 Watt::From<Prefix::Milli>(2500));
+    REQUIRE(interval == Second64::From<Prefix::Nano>(-2000000000000000));
+}
+
+TEST_CASE("Int128_NarrowingFollowsPolicy")
+{
+    auto const wrapped = UnitMult<IntegralValueSystem, Joule64>(
+            Watt::From<Prefix::Milli>(std::numeric_limits<int>::max()),
+            Second64::From<Prefix::Nano>(std::numeric_limits<std::int64_t>::max()));
+    auto const saturated = UnitMult<IntegralValueSystem, Joule64Sat>(
+            Watt::From<Prefix::Milli>(std::numeric_limits<int>::max()),
+            Second64::From<Prefix::Nano>(std::numeric_limits<std::int64_t>::max()));
+    auto const saturatedNegative = UnitMult<IntegralValueSystem, Joule64Sat>(
+            Watt::From<Prefix::Milli>(std::numeric_limits<int>::min()),
+            Second64::From<Prefix::Nano>(std::numeric_limits<std::int64_t>::max()));
+
+    Int128 const exact = Int128(std::numeric_limits<int>::max()) * std::numeric_limits<std::int64_t>::max() / 1000000;
+    REQUIRE(wrapped.To<Prefix::Micro>() == static_cast<std::int64_t>(exact));
+    REQUIRE(saturated.To<Prefix::Micro>() == std::numeric_limits<std::int64_t>::max());
+    REQUIRE(saturatedNegative.To<Prefix::Micro>() == std::numeric_limits<std::int64_t>::min());
+}
+
+TEST_CASE("Int128_ScaleAndQuotientMatchPlainDivision")
+{
+    std::mt19937_64 rng(7);
+    for (int i = 0; i < 20000; ++i) {
+        // Alternate between values within and beyond the 64 bit range
+        auto const low = rng();
+        auto const high = (i % 2 == 0) ? static_cast<std::int64_t>(-(low >> 63)) : static_cast<std::int64_t>(rng());
+        Int128 const val = Big(high, low);
+        Int128 const divisor = (i % 3 == 0) ? Int128(-1) : Int128(static_cast<std::int64_t>(rng()) >> (i % 60));
+
+        REQUIRE((detail::MultiplyWithExponent<-6>(val) == val / 1000000));
+        REQUIRE((detail::MultiplyWithExponent<-9>(val) == val / 1000000000));
+        if (divisor != 0 && !(divisor == -1 && val == detail::Limits<Int128>::min())) {
+            REQUIRE((detail::Quotient(val, divisor) == val / divisor));
+        }
+    }
+    REQUIRE((detail::Quotient(Int128(std::numeric_limits<std::int64_t>::min()), Int128(-1))
+             == -Int128(std::numeric_limits<std::int64_t>::min())));
+}
+
+TEST_CASE("Int128_OverflowPolicies")
+{
+    Int128 const max = detail::Limits<Int128>::max();
+    Int128 const min = detail::Limits<Int128>::min();
+
+    REQUIRE((SaturateOverflow::Mul(max / 3, Int128(4)) == max));
+    REQUIRE((SaturateOverflow::Mul(Int128(std::numeric_limits<std::int64_t>::min()),
+                                   Int128(std::numeric_limits<std::int64_t>::min()))
+             == Int128(std::numeric_limits<std::int64_t>::min()) * std::numeric_limits<std::int64_t>::min()));
+    REQUIRE((SaturateOverflow::Add(max, Int128(1)) == max));
+    REQUIRE((SaturateOverflow::Div(min, Int128(-1)) == max));
+    REQUIRE((WrapOverflow::Add(max, Int128(1)) == min));
+    REQUIRE((WrapOverflow::Scale<3>(Int128(-5)) == -5000));
+    REQUIRE((SaturateOverflow::Narrow<std::int64_t>(max) == std::numeric_limits<std::int64_t>::max()));
+}
+
+#endif
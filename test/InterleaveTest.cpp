@@ -0,0 +1,124 @@
+#include <catch.hpp>
+#include <IntegralUnits/Conversions.hpp>
+#include <LightUnits/Interleave.hpp>
+#include <LightUnits/UnitArray.hpp>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace LightUnits;
+
+using StereoFrontEnd = ChannelLayout<Channel<Volt, Prefix::Milli>, Channel<Ampere, Prefix::Milli>>;
+using ThreePhase = ChannelLayout<Channel<Volt, Prefix::One>, Channel<Volt>, Channel<Ampere>,
+        Channel<Ampere, Prefix::Milli>>;
+
+static std::vector<std::int16_t> RandomSamples(std::size_t count, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(std::numeric_limits<std::int16_t>::min(),
+                                            std::numeric_limits<std::int16_t>::max());
+    std::vector<std::int16_t> samples;
+    for (std::size_t i = 0; i < count; ++i) {
+        samples.push_back(static_cast<std::int16_t>(dist(rng)));
+    }
+    return samples;
+}
+
+TEST_CASE("Interleave_TwoChannelsConvertPrefix")
+{
+    // 5 frames: four in the vector loop, one in the scalar tail
+    std::vector<std::int16_t> const frames = {100, 1, -200, 2, 300, -3, 32767, 4, -32768, 5};
+    UnitArray<Volt> volts(5);
+    UnitArray<Ampere> currents(5);
+
+    StereoFrontEnd::Deinterleave(MakeSpan(frames), volts.Span(), currents.Span());
+
+    REQUIRE(volts[0] == 100_mV);
+    REQUIRE(volts[3] == 32767_mV);
+    REQUIRE(volts[4] == -32768_mV);
+    REQUIRE(currents[1] == 2_mA);
+    REQUIRE(currents[2] == -3_mA);
+    REQUIRE(currents[4] == 5_mA);
+}
+
+TEST_CASE("Interleave_FourChannelsMatchScalarConversion")
+{
+    auto const frames = RandomSamples(4 * 1003, 1);
+    UnitArray<Volt> v1(1003), v2(1003);
+    UnitArray<Ampere> i1(1003), i2(1003);
+
+    ThreePhase::Deinterleave(MakeSpan(frames), v1.Span(), v2.Span(), i1.Span(), i2.Span());
+
+    for (std::size_t f = 0; f < 1003; ++f) {
+        REQUIRE(v1[f] == Volt::From<Prefix::One>(frames[4 * f]));
+        REQUIRE(v2[f] == Volt::From<Prefix::Milli>(frames[4 * f + 1]));
+        REQUIRE(i1[f] == Ampere::From<Prefix::Micro>(frames[4 * f + 2]));
+        REQUIRE(i2[f] == Ampere::From<Prefix::Milli>(frames[4 * f + 3]));
+    }
+}
+
+TEST_CASE("Interleave_ScalarLayouts")
+{
+    // Three channels and a finer source prefix which needs a division
+    using Layout = ChannelLayout<Channel<Volt, Prefix::Micro>, Channel<Ampere>, Channel<Ohm, Prefix::Kilo>>;
+    std::vector<int> const frames = {1500, 7, 2, -2500, 8, 3};
+    UnitArray<Volt> volts(2);
+    UnitArray<Ampere> currents(2);
+    UnitArray<Ohm> resistances(2);
+
+    Layout::Deinterleave(MakeSpan(frames), volts.Span(), currents.Span(), resistances.Span());
+
+    REQUIRE(volts[0] == 1_mV);
+    REQUIRE(volts[1] == -2_mV);
+    REQUIRE(currents[1] == 8_uA);
+    REQUIRE(resistances[0] == 2_kOhm);
+}
+
+TEST_CASE("Interleave_RoundTripForDac")
+{
+    auto const frames = RandomSamples(2 * 999, 2);
+    UnitArray<Volt> volts(999);
+    UnitArray<Ampere> currents(999);
+    StereoFrontEnd::Deinterleave(MakeSpan(frames), volts.Span(), currents.Span());
+
+    std::vector<std::int16_t> output(frames.size());
+    StereoFrontEnd::Interleave(MakeSpan(output), volts.Span(), currents.Span());
+
+    REQUIRE(output == frames);
+}
+
+TEST_CASE("Interleave_SaturatesAtSampleRange")
+{
+    using DacLayout = ChannelLayout<Channel<Volt>, Channel<Volt>>;
+    UnitArray<Volt> const a = {40_V, -40_V, 1_mV, 0_V, 50_V};
+    UnitArray<Volt> const b = {2_mV, 3_mV, -33_V, 33_V, -1_mV};
+    std::vector<std::int16_t> output(10);
+
+    DacLayout::Interleave(MakeSpan(output), a.Span(), b.Span());
+
+    REQUIRE(output == std::vector<std::int16_t>({32767, 2, -32768, 3, 1, -32768, 0, 32767, 32767, -1}));
+}
+
+TEST_CASE("Interleave_RuntimeLayout")
+{
+    RuntimeChannelLayout const layout({Prefix::Milli, Prefix::Milli, Prefix::Micro});
+    std::vector<std::int16_t> const frames = {100, 5, 1234, -100, 6, -1234};
+    UnitArray<Volt> volts(2);
+    UnitArray<Ampere> currents(2);
+    UnitArray<Volt> fine(2);
+
+    layout.Deinterleave(MakeSpan(frames), 0, volts.Span());
+    layout.Deinterleave(MakeSpan(frames), 1, currents.Span());
+    layout.Deinterleave(MakeSpan(frames), 2, fine.Span());
+
+    REQUIRE(volts[1] == -100_mV);
+    REQUIRE(currents[0] == 5_mA);
+    REQUIRE(fine[0] == 1_mV);
+
+    std::vector<std::int16_t> output(6);
+    layout.Interleave(MakeSpan(output), 0, volts.Span());
+    layout.Interleave(MakeSpan(output), 1, currents.Span());
+    layout.Interleave(MakeSpan(output), 2, fine.Span());
+    REQUIRE(output == std::vector<std::int16_t>({100, 5, 1000, -100, 6, -1000}));
+}
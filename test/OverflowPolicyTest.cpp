@@ -0,0 +1,276 @@
+#include <catch.hpp>
+#include <IntegralUnits/Conversions.hpp>
+#include <IntegralUnits/IntegralRatio.hpp>
+#include <LightUnits/BatchArithmetic.hpp>
+#include <LightUnits/GenericConversions.hpp>
+#include <LightUnits/Ratio.hpp>
+#include <LightUnits/UnitArray.hpp>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace LightUnits;
+
+struct VoltMilliSaturating16 {
+    static Prefix const BasePrefix = Prefix::Milli;
+    typedef std::int16_t ValueType;
+    typedef SaturateOverflow OverflowPolicy;
+};
+
+struct VoltMilliSaturating32 {
+    static Prefix const BasePrefix = Prefix::Milli;
+    typedef std::int32_t ValueType;
+    typedef SaturateOverflow OverflowPolicy;
+};
+
+struct AmpereMilliSaturating8 {
+    static Prefix const BasePrefix = Prefix::Milli;
+    typedef std::int8_t ValueType;
+    typedef SaturateOverflow OverflowPolicy;
+};
+
+struct VoltMilliTrapping {
+    static Prefix const BasePrefix = Prefix::Milli;
+    typedef std::int16_t ValueType;
+    typedef TrapOverflow OverflowPolicy;
+};
+
+struct AmpereMilliSaturating16 {
+    static Prefix const BasePrefix = Prefix::Milli;
+    typedef std::int16_t ValueType;
+    typedef SaturateOverflow OverflowPolicy;
+};
+
+struct OhmSaturating16 {
+    static Prefix const BasePrefix = Prefix::One;
+    typedef std::int16_t ValueType;
+    typedef SaturateOverflow OverflowPolicy;
+};
+
+using Volt16 = BaseUnit<Volt_t, VoltMilliSaturating16>;
+using Ampere16 = BaseUnit<Ampere_t, AmpereMilliSaturating16>;
+using Ohm16 = BaseUnit<Ohm_t, OhmSaturating16>;
+using VoltSat = BaseUnit<Volt_t, VoltMilliSaturating32>;
+using Ampere8 = BaseUnit<Ampere_t, AmpereMilliSaturating8>;
+using VoltTrap = BaseUnit<Volt_t, VoltMilliTrapping>;
+
+static void ThrowOnOverflow(char const *operation)
+{
+    throw std::overflow_error(operation);
+}
+
+/// Installs ThrowOnOverflow for the lifetime of the object
+class TrapToException {
+public:
+    TrapToException()
+            : m_previous(SetOverflowTrapHandler(&ThrowOnOverflow)) {
+    }
+
+    ~TrapToException() {
+        SetOverflowTrapHandler(m_previous);
+    }
+
+private:
+    OverflowTrapHandler m_previous;
+};
+
+static_assert(std::is_same<Volt::OverflowPolicy, WrapOverflow>::value, "Wrap is the default");
+static_assert(std::is_same<Volt16::OverflowPolicy, SaturateOverflow>::value, "");
+
+TEST_CASE("OverflowPolicy_WrapIsTwosComplement")
+{
+    auto const max = std::numeric_limits<Volt>::max();
+    auto const min = std::numeric_limits<Volt>::min();
+
+    REQUIRE(max + 1_mV == min);
+    REQUIRE(min - 1_mV == max);
+    REQUIRE(-min == min);
+    REQUIRE(max * 2 == -2_mV);
+}
+
+TEST_CASE("OverflowPolicy_SaturateOperators")
+{
+    auto const max = std::numeric_limits<Volt16>::max();
+    auto const min = std::numeric_limits<Volt16>::min();
+    auto const one = Volt16::From<Prefix::Milli>(1);
+
+    REQUIRE(max + one == max);
+    REQUIRE(min - one == min);
+    REQUIRE(-min == max);
+    REQUIRE(max * std::int16_t(2) == max);
+    REQUIRE(max * std::int16_t(-2) == min);
+    REQUIRE(min / std::int16_t(-1) == max);
+    REQUIRE(max * 10.0f == max);
+    REQUIRE(min * 10.0f == min);
+
+    auto sum = max;
+    sum += one;
+    REQUIRE(sum == max);
+    sum -= max;
+    REQUIRE(sum == Volt16::From<Prefix::Milli>(0));
+}
+
+TEST_CASE("OverflowPolicy_SaturateFromTo")
+{
+    REQUIRE(Volt16::From<Prefix::One>(40) == std::numeric_limits<Volt16>::max());
+    REQUIRE(Volt16::From<Prefix::One>(-40) == std::numeric_limits<Volt16>::min());
+    REQUIRE(Volt16::From<Prefix::One>(30).To<Prefix::Milli>() == 30000);
+    REQUIRE(Volt16::From<Prefix::Milli>(30000).To<Prefix::Micro>() == std::numeric_limits<std::int16_t>::max());
+    REQUIRE(Volt16::FromFloat(1e9f) == std::numeric_limits<Volt16>::max());
+}
+
+TEST_CASE("OverflowPolicy_SaturateConversionHelpers")
+{
+    auto const v = VoltSat::From<Prefix::One>(3000000);
+    auto const i = Ampere::From<Prefix::One>(2000);
+    REQUIRE(UnitMult<IntegralValueSystem, VoltSat>(i, Ohm::From<Prefix::One>(2000)) ==
+            std::numeric_limits<VoltSat>::max());
+    REQUIRE(UnitDiv<IntegralValueSystem, VoltSat>(Watt::From<Prefix::Kilo>(-2000), 1_uA) ==
+            std::numeric_limits<VoltSat>::min());
+    REQUIRE(v == std::numeric_limits<VoltSat>::max());
+}
+
+TEST_CASE("OverflowPolicy_TrapCallsHandler")
+{
+    TrapToException trap;
+    auto const max = std::numeric_limits<VoltTrap>::max();
+    auto const one = VoltTrap::From<Prefix::Milli>(1);
+
+    REQUIRE(max - one + one == max);
+    REQUIRE_THROWS_AS(max + one, std::overflow_error);
+    REQUIRE_THROWS_AS(max * std::int16_t(2), std::overflow_error);
+    REQUIRE_THROWS_AS(-std::numeric_limits<VoltTrap>::min(), std::overflow_error);
+    REQUIRE_THROWS_AS(VoltTrap::From<Prefix::One>(100), std::overflow_error);
+    REQUIRE_THROWS_AS(max.To<Prefix::Micro>(), std::overflow_error);
+}
+
+TEST_CASE("OverflowPolicy_SaturatingAddBatchMatchesScalar")
+{
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> dist32(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+    std::uniform_int_distribution<int> dist16(std::numeric_limits<std::int16_t>::min(),
+                                              std::numeric_limits<std::int16_t>::max());
+    std::uniform_int_distribution<int> dist8(std::numeric_limits<std::int8_t>::min(),
+                                             std::numeric_limits<std::int8_t>::max());
+
+    std::size_t const count = 1001;
+    UnitArray<VoltSat> a32(count), b32(count), sum32(count), diff32(count);
+    UnitArray<Volt16> a16(count), b16(count), sum16(count), diff16(count);
+    UnitArray<Ampere8> a8(count), b8(count), sum8(count), diff8(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        a32[i] = VoltSat::From<Prefix::Milli>(dist32(rng));
+        b32[i] = VoltSat::From<Prefix::Milli>(dist32(rng));
+        a16[i] = Volt16::From<Prefix::Milli>(static_cast<std::int16_t>(dist16(rng)));
+        b16[i] = Volt16::From<Prefix::Milli>(static_cast<std::int16_t>(dist16(rng)));
+        a8[i] = Ampere8::From<Prefix::Milli>(static_cast<std::int8_t>(dist8(rng)));
+        b8[i] = Ampere8::From<Prefix::Milli>(static_cast<std::int8_t>(dist8(rng)));
+    }
+
+    AddBatch(a32.Span(), b32.Span(), sum32.Span());
+    SubBatch(a32.Span(), b32.Span(), diff32.Span());
+    AddBatch(a16.Span(), b16.Span(), sum16.Span());
+    SubBatch(a16.Span(), b16.Span(), diff16.Span());
+    AddBatch(a8.Span(), b8.Span(), sum8.Span());
+    SubBatch(a8.Span(), b8.Span(), diff8.Span());
+
+    for (std::size_t i = 0; i < count; ++i) {
+        REQUIRE(sum32[i] == a32[i] + b32[i]);
+        REQUIRE(diff32[i] == a32[i] - b32[i]);
+        REQUIRE(sum16[i] == a16[i] + b16[i]);
+        REQUIRE(diff16[i] == a16[i] - b16[i]);
+        REQUIRE(sum8[i] == a8[i] + b8[i]);
+        REQUIRE(diff8[i] == a8[i] - b8[i]);
+    }
+}
+
+TEST_CASE("OverflowPolicy_WrappingAddBatch")
+{
+    UnitArray<Volt> const a = {std::numeric_limits<Volt>::max(), 1_V, -2_V};
+    UnitArray<Volt> const b = {1_mV, 2_V, 3_V};
+    UnitArray<Volt> sum(3);
+
+    AddBatch(a.Span(), b.Span(), sum.Span());
+
+    REQUIRE(sum[0] == std::numeric_limits<Volt>::min());
+    REQUIRE(sum[1] == 3_V);
+    REQUIRE(sum[2] == 1_V);
+}
+
+TEST_CASE("OverflowPolicy_ConvertBatchSaturatingPack")
+{
+    UnitArray<Volt> wide(19);
+    for (std::size_t i = 0; i < wide.size(); ++i) {
+        wide[i] = (static_cast<int>(i) - 9) * 5_V;
+    }
+    UnitArray<Volt16> narrow(19);
+
+    ConvertBatch(wide.Span(), narrow.Span());
+
+    REQUIRE(narrow[0] == std::numeric_limits<Volt16>::min());
+    REQUIRE(narrow[2] == std::numeric_limits<Volt16>::min());
+    REQUIRE(narrow[3] == Volt16::From<Prefix::One>(-30));
+    REQUIRE(narrow[4] == Volt16::From<Prefix::One>(-25));
+    REQUIRE(narrow[9] == Volt16::From<Prefix::Milli>(0));
+    REQUIRE(narrow[15] == Volt16::From<Prefix::One>(30));
+    REQUIRE(narrow[16] == std::numeric_limits<Volt16>::max());
+    REQUIRE(narrow[18] == std::numeric_limits<Volt16>::max());
+
+    // Different prefix: scalar path
+    UnitArray<Ampere> currents = {1_A, -200_A};
+    UnitArray<Ampere8> small(2);
+    ConvertBatch(currents.Span(), small.Span());
+    REQUIRE(small[0] == std::numeric_limits<Ampere8>::max());
+    REQUIRE(small[1] == std::numeric_limits<Ampere8>::min());
+}
+
+TEST_CASE("OverflowPolicy_ConversionBatchesNarrowLikeScalar")
+{
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<int> dist32(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+    std::uniform_int_distribution<int> dist16(std::numeric_limits<std::int16_t>::min(),
+                                              std::numeric_limits<std::int16_t>::max());
+
+    std::size_t const count = 1001;
+    UnitArray<Ampere16> currents(count);
+    UnitArray<Ohm16> resistances(count);
+    UnitArray<VoltSat> voltages(count);
+    UnitArray<IntegralRatio> ratios(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        currents[i] = Ampere16::From<Prefix::Milli>(static_cast<std::int16_t>(dist16(rng)));
+        int const ohm = dist16(rng) >> (i % 15);
+        resistances[i] = Ohm16::From<Prefix::One>(static_cast<std::int16_t>(ohm == 0 ? 1 : ohm));
+        voltages[i] = VoltSat::From<Prefix::Milli>(dist32(rng) >> (i % 31));
+        ratios[i] = IntegralRatio::FromRaw(dist32(rng) >> (i % 23));
+    }
+
+    // int16 * int16 narrowed from int32 (packssdw), int64 narrowed into int32 and int16 (clamps)
+    UnitArray<Volt16> products16(count);
+    UnitArray<VoltSat> products32(count);
+    UnitMultBatch<IntegralValueSystem>(currents.Span(), resistances.Span(), products16.Span());
+    UnitMultBatch<IntegralValueSystem>(voltages.Span(), resistances.Span(), products32.Span());
+
+    UnitArray<Ampere16> quotients(count);
+    UnitDivBatch<IntegralValueSystem>(voltages.Span(), resistances.Span(), quotients.Span());
+
+    UnitArray<VoltSat> scaled(count);
+    ApplyRatioBatch<IntegralValueSystem>(voltages.Span(), ratios.Span(), scaled.Span());
+
+    for (std::size_t i = 0; i < count; ++i) {
+        REQUIRE(products16[i] == UnitMult<IntegralValueSystem, Volt16>(currents[i], resistances[i]));
+        REQUIRE(products32[i] == UnitMult<IntegralValueSystem, VoltSat>(voltages[i], resistances[i]));
+        REQUIRE(quotients[i] == UnitDiv<IntegralValueSystem, Ampere16>(voltages[i], resistances[i]));
+        REQUIRE(scaled[i] == ApplyRatio<IntegralValueSystem>(voltages[i], ratios[i]));
+    }
+
+    TrapToException trap;
+    UnitArray<Volt16> const volts = {Volt16::From<Prefix::One>(1), Volt16::From<Prefix::One>(2)};
+    UnitArray<Ohm16> const small = {Ohm16::From<Prefix::One>(3), Ohm16::From<Prefix::One>(3)};
+    UnitArray<Ohm16> const large = {Ohm16::From<Prefix::One>(3), Ohm16::From<Prefix::One>(30)};
+    UnitArray<VoltTrap> trapped(2);
+    UnitMultBatch<IntegralValueSystem>(volts.Span(), small.Span(), trapped.Span());
+    REQUIRE(trapped[1] == VoltTrap::From<Prefix::One>(6));
+    REQUIRE_THROWS_AS(UnitMultBatch<IntegralValueSystem>(volts.Span(), large.Span(), trapped.Span()),
+                      std::overflow_error);
+}
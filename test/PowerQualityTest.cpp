@@ -0,0 +1,296 @@
+#include <catch.hpp>
+#include <IntegralUnits/Conversions.hpp>
+#include <LightUnits/PowerQuality.hpp>
+#include <LightUnits/UnitArray.hpp>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+using namespace LightUnits;
+
+using PowerFactor = Ratio<int, 16>;
+
+/// One mains cycle sampled per window, with the given amplitude and phase in degrees
+template<typename Unit>
+static UnitArray<Unit> Sine(std::size_t samples, std::size_t window, double amplitudeRaw, double phaseDegrees)
+{
+    UnitArray<Unit> values(samples);
+    double const pi = std::acos(-1.0);
+    for (std::size_t i = 0; i < samples; ++i) {
+        double const angle = 2 * pi * static_cast<double>(i) / static_cast<double>(window) + phaseDegrees * pi / 180;
+        values[i] = Unit::template From<Unit::BasePrefix>(
+                static_cast<typename Unit::ValueType>(std::lround(amplitudeRaw * std::sin(angle))));
+    }
+    return values;
+}
+
+TEST_CASE("PowerQuality_IntegerSqrt")
+{
+    for (std::uint64_t x = 0; x < 100000; ++x) {
+        auto const root = detail::IntegerSqrt(x);
+        REQUIRE(std::uint64_t(root) * root <= x);
+        REQUIRE((std::uint64_t(root) + 1) * (std::uint64_t(root) + 1) > x);
+    }
+    std::mt19937_64 rng(3);
+    for (int i = 0; i < 10000; ++i) {
+        std::uint64_t const k = rng() >> (32 + i % 32);
+        REQUIRE(detail::IntegerSqrt(k * k) == k);
+        if (k > 0) {
+            REQUIRE(detail::IntegerSqrt(k * k - 1) == k - 1);
+        }
+    }
+    REQUIRE(detail::IntegerSqrt(~std::uint64_t(0)) == 0xFFFFFFFFu);
+}
+
+TEST_CASE("PowerQuality_IntegerSqrtBatchMatchesScalar")
+{
+    std::vector<std::uint32_t> in{0, 1, 2, 3, 4, 65535u * 65535u - 1, 65535u * 65535u, 0x80000000u, 0xFFFFFFFFu};
+    std::mt19937 rng(9);
+    for (int i = 0; i < 10003; ++i) {
+        in.push_back(static_cast<std::uint32_t>(rng()) >> (i % 32));
+    }
+    std::vector<std::uint32_t> out(in.size());
+    detail::IntegerSqrtBatch(in.data(), out.data(), in.size());
+    for (std::size_t i = 0; i < in.size(); ++i) {
+        REQUIRE(out[i] == detail::IntegerSqrt(in[i]));
+    }
+}
+
+TEST_CASE("PowerQuality_SquareRootPrefixes")
+{
+    REQUIRE((SquareRoot<Volt, Prefix::Milli>(4000000) == 2_V));
+    REQUIRE((SquareRoot<Volt, Prefix::One>(4) == 2_V));
+    REQUIRE((SquareRoot<Volt, Prefix::One>(2) == 1414_mV));
+    REQUIRE((SquareRoot<Ampere, Prefix::Milli>(2) == 1414_uA));
+    REQUIRE((SquareRoot<Volt, Prefix::Micro>(2000000) == 1_mV));
+}
+
+TEST_CASE("PowerQuality_IntegerSqrtBatchOf64BitMatchesScalar")
+{
+    std::uint64_t const max = std::numeric_limits<std::uint64_t>::max();
+    std::vector<std::uint64_t> in{0, 1, 2, 0xFFFFFFFEull * 0xFFFFFFFEull, 0xFFFFFFFFull * 0xFFFFFFFFull - 1,
+                                  0xFFFFFFFFull * 0xFFFFFFFFull, max - 1, max, std::uint64_t(1) << 63};
+    std::mt19937_64 rng(13);
+    for (int i = 0; i < 10003; ++i) {
+        std::uint64_t const val = rng() >> (i % 64);
+        in.push_back(val);
+        // Around perfect squares, where the double estimate may land on either side
+        std::uint64_t const root = detail::IntegerSqrt(val);
+        in.push_back(root * root);
+        if (root > 0) {
+            in.push_back(root * root - 1);
+        }
+    }
+    std::vector<std::uint32_t> out(in.size());
+    detail::IntegerSqrtBatch(in.data(), out.data(), in.size());
+    for (std::size_t i = 0; i < in.size(); ++i) {
+        REQUIRE(out[i] == detail::IntegerSqrt(in[i]));
+    }
+}
+
+struct VoltMilli16Saturating {
+    static Prefix const BasePrefix = Prefix::Milli;
+    typedef std::int16_t ValueType;
+    typedef SaturateOverflow OverflowPolicy;
+};
+
+using Volt16Sat = BaseUnit<Volt_t, VoltMilli16Saturating>;
+
+TEST_CASE("PowerQuality_SquareRootBatchMatchesScalar")
+{
+    std::vector<std::uint64_t> squares{0, 1, 2, 4000000, 1073676289, 1073741824, 4294967296ull, ~std::uint64_t(0)};
+    std::mt19937_64 rng(17);
+    for (int i = 0; i < 1000; ++i) {
+        squares.push_back(rng() >> (i % 64));
+    }
+
+    UnitArray<Volt> volts(squares.size());
+    SquareRootBatch<Volt, Prefix::Micro>(MakeSpan(squares), volts.Span());
+    UnitArray<Volt16Sat> narrow(squares.size());
+    SquareRootBatch<Volt16Sat, Prefix::Milli>(MakeSpan(squares), narrow.Span());
+    for (std::size_t i = 0; i < squares.size(); ++i) {
+        REQUIRE((volts[i] == SquareRoot<Volt, Prefix::Micro>(squares[i])));
+        REQUIRE((narrow[i] == SquareRoot<Volt16Sat, Prefix::Milli>(squares[i])));
+    }
+    REQUIRE(narrow[7] == std::numeric_limits<Volt16Sat>::max());
+}
+
+TEST_CASE("PowerQuality_RmsMeterManyWindowsPerCall")
+{
+    // More completed windows than one root block, and a window left open across the calls
+    std::mt19937 rng(21);
+    std::uniform_int_distribution<int> dist(-2000000000, 2000000000);
+    UnitArray<Volt> samples(3 * 157 + 2);
+    for (auto &value : samples) {
+        value = Volt::From<Prefix::Milli>(dist(rng));
+    }
+
+    RmsMeter<IntegralValueSystem, Volt> meter(3);
+    UnitArray<Volt> rms(157);
+    REQUIRE(meter.Process(samples.Span().subspan(0, 400), rms.Span()) == 133);
+    REQUIRE(meter.Process(samples.Span().subspan(400), rms.Span().subspan(133)) == 24);
+    for (std::size_t w = 0; w < rms.size(); ++w) {
+        detail::WideWindowSum sum;
+        for (std::size_t i = 3 * w; i < 3 * w + 3; ++i) {
+            std::int64_t const raw = samples[i].To<Prefix::Milli>();
+            sum.Add(raw * raw);
+        }
+        REQUIRE((rms[w] == SquareRoot<Volt, Prefix::Milli>(static_cast<std::uint64_t>(sum.Mean<std::int64_t>(3)))));
+    }
+}
+
+TEST_CASE("PowerQuality_RmsMeterWindowsAcrossBlocks")
+{
+    UnitArray<Volt> samples(8);
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = (i % 2 == 0) ? 3_V : Volt::From<Prefix::One>(-4);
+    }
+
+    RmsMeter<IntegralValueSystem, Volt> meter(2);
+    UnitArray<Volt> rms(4);
+    REQUIRE(meter.OutputsFor(3) == 1);
+    REQUIRE(meter.Process(samples.Span().subspan(0, 3), rms.Span()) == 1);
+    REQUIRE(meter.OutputsFor(5) == 3);
+    REQUIRE(meter.Process(samples.Span().subspan(3), rms.Span().subspan(1)) == 3);
+    for (auto value : rms) {
+        // sqrt((9 + 16) / 2) V
+        REQUIRE(value == 3535_mV);
+    }
+}
+
+TEST_CASE("PowerQuality_RmsOfMainsVoltage")
+{
+    auto const voltage = Sine<Volt>(4000, 400, 325269.0, 0);   // 230 V RMS
+    RmsMeter<IntegralValueSystem, Volt> meter(400);
+    UnitArray<Volt> rms(meter.OutputsFor(voltage.size()));
+    REQUIRE(meter.Process(voltage.Span(), rms.Span()) == 10);
+    for (auto value : rms) {
+        REQUIRE(value >= 229999_mV);
+        REQUIRE(value <= 230001_mV);
+    }
+}
+
+TEST_CASE("PowerQuality_PowerAnalyzerPhaseShift")
+{
+    auto const voltage = Sine<Volt>(1000, 200, 325269.0, 0);
+    std::vector<std::pair<double, double>> const cases{{0, 1.0}, {60, 0.5}, {90, 0.0}, {180, -1.0}};
+
+    for (auto const &testCase : cases) {
+        auto const current = Sine<Ampere>(1000, 200, 14142136.0, -testCase.first);   // 10 A RMS
+        PowerAnalyzer<IntegralValueSystem, Volt, Ampere, Watt, PowerFactor> analyzer(200);
+        std::vector<decltype(analyzer)::Reading> readings;
+
+        // Blocks not aligned to the window
+        REQUIRE(analyzer.Process(voltage.Span().subspan(0, 333), current.Span().subspan(0, 333), readings) == 1);
+        REQUIRE(analyzer.Process(voltage.Span().subspan(333), current.Span().subspan(333), readings) == 4);
+
+        for (auto const &reading : readings) {
+            REQUIRE(std::abs(reading.voltageRms.ToFloat() - 230.0f) < 0.01f);
+            REQUIRE(std::abs(reading.currentRms.ToFloat() - 10.0f) < 0.001f);
+            REQUIRE(std::abs(reading.apparentPower.ToFloat() - 2300.0f) < 1.0f);
+            REQUIRE(std::abs(reading.realPower.ToFloat() - 2300.0f * testCase.second) < 1.0f);
+            REQUIRE(std::abs(reading.powerFactor.ToFloat() - testCase.second) < 0.001f);
+            REQUIRE(reading.powerFactor <= PowerFactor::FromInteger(1));
+            REQUIRE(reading.powerFactor >= PowerFactor::FromInteger(-1));
+        }
+    }
+}
+
+TEST_CASE("PowerQuality_PowerAnalyzerWithoutCurrent")
+{
+    auto const voltage = Sine<Volt>(100, 100, 325269.0, 0);
+    UnitArray<Ampere> current(100);
+    std::fill(current.begin(), current.end(), 0_A);
+
+    PowerAnalyzer<IntegralValueSystem, Volt, Ampere, Watt> analyzer(100);
+    std::vector<decltype(analyzer)::Reading> readings;
+    analyzer.Process(voltage.Span(), current.Span(), readings);
+
+    REQUIRE(readings.size() == 1);
+    REQUIRE(readings[0].realPower == 0_W);
+    REQUIRE(readings[0].apparentPower == 0_W);
+    REQUIRE(readings[0].powerFactor == PowerFactor::FromRaw(0));
+}
+
+struct VoltMilli16 {
+    static Prefix const BasePrefix = Prefix::Milli;
+    typedef std::int16_t ValueType;
+};
+
+using Volt16 = BaseUnit<Volt_t, VoltMilli16>;
+
+// IntegralValueSystem as on targets without __int128: no type larger than the int64 squares of 32 bit units
+using SystemWithoutInt128 = ValueSystem<std::int8_t, std::int16_t, int, std::int64_t>;
+
+static_assert(std::is_same<RmsMeter<SystemWithoutInt128, Volt>::SumType, detail::WideWindowSum>::value, "");
+static_assert(std::is_same<RmsMeter<SystemWithoutInt128, Volt16>::SumType, detail::WindowSum<std::int64_t>>::value,
+              "16 bit units sum their int32 squares in int64");
+
+TEST_CASE("PowerQuality_WideWindowSum")
+{
+    std::int64_t const max = std::numeric_limits<std::int64_t>::max();
+    std::int64_t const min = std::numeric_limits<std::int64_t>::min();
+
+    detail::WideWindowSum sum;
+    for (int i = 0; i < 1000; ++i) {
+        sum.Add(max);
+    }
+    REQUIRE(sum.Mean<std::int64_t>(1000) == max);
+
+    sum.Reset();
+    for (int i = 0; i < 1000; ++i) {
+        sum.Add(min);
+    }
+    REQUIRE(sum.Mean<std::int64_t>(1000) == min);
+
+    // Truncation towards zero as for the built-in division
+    sum.Reset();
+    sum.Add(std::int64_t(-7));
+    REQUIRE(sum.Mean<std::int64_t>(2) == -3);
+    sum.Add(std::int64_t(14));
+    REQUIRE(sum.Mean<std::int64_t>(2) == 3);
+
+#if defined(LIGHTUNITS_HAS_INT128)
+    std::mt19937_64 rng(5);
+    detail::WideWindowSum wide;
+    detail::WindowSum<Int128> native;
+    for (std::size_t i = 1; i <= 5000; ++i) {
+        auto const val = static_cast<std::int64_t>(rng()) >> (i % 40);
+        wide.Add(val);
+        native.Add(val);
+        REQUIRE(wide.Mean<std::int64_t>(i) == native.Mean<std::int64_t>(i));
+    }
+#endif
+}
+
+TEST_CASE("PowerQuality_WithoutInt128MatchesIntegralValueSystem")
+{
+    // Full scale samples: the sum of squares exceeds int64 after 2 samples
+    UnitArray<Volt> fullScale(1000);
+    std::fill(fullScale.begin(), fullScale.end(), std::numeric_limits<Volt>::max());
+    RmsMeter<SystemWithoutInt128, Volt> meter(1000);
+    Volt rms;
+    REQUIRE(meter.Process(fullScale.Span(), UnitSpan<Volt>(&rms, 1)) == 1);
+    REQUIRE(rms == std::numeric_limits<Volt>::max());
+
+    auto const voltage = Sine<Volt>(1000, 200, 325269.0, 0);
+    auto const current = Sine<Ampere>(1000, 200, 14142136.0, -150);
+    PowerAnalyzer<SystemWithoutInt128, Volt, Ampere, Watt> wide(200);
+    PowerAnalyzer<IntegralValueSystem, Volt, Ampere, Watt> reference(200);
+    std::vector<decltype(wide)::Reading> readings;
+    std::vector<decltype(reference)::Reading> expected;
+    REQUIRE(wide.Process(voltage.Span(), current.Span(), readings) == 5);
+    REQUIRE(reference.Process(voltage.Span(), current.Span(), expected) == 5);
+
+    for (std::size_t i = 0; i < readings.size(); ++i) {
+        REQUIRE(readings[i].voltageRms == expected[i].voltageRms);
+        REQUIRE(readings[i].currentRms == expected[i].currentRms);
+        REQUIRE(readings[i].realPower == expected[i].realPower);
+        REQUIRE(readings[i].apparentPower == expected[i].apparentPower);
+        REQUIRE(readings[i].powerFactor == expected[i].powerFactor);
+        REQUIRE(readings[i].realPower < 0_W);
+    }
+}
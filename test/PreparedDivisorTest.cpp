@@ -0,0 +1,135 @@
+#include <catch.hpp>
+#include <IntegralUnits/Conversions.hpp>
+#include <LightUnits/PreparedDivisor.hpp>
+#include <LightUnits/UnitArray.hpp>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace LightUnits;
+
+struct AmpereMicroSaturating {
+    static Prefix const BasePrefix = Prefix::Micro;
+    typedef std::int32_t ValueType;
+    typedef SaturateOverflow OverflowPolicy;
+};
+
+struct OhmMicro64 {
+    static Prefix const BasePrefix = Prefix::Micro;
+    typedef std::int64_t ValueType;
+};
+
+using AmpereSat = BaseUnit<Ampere_t, AmpereMicroSaturating>;
+using Ohm64 = BaseUnit<Ohm_t, OhmMicro64>;
+
+TEST_CASE("PreparedDivisor_UnsignedReciprocal")
+{
+    std::vector<std::uint64_t> divisors{1, 2, 3, 5, 7, 10, 641, 1000, 1u << 31, (1ull << 32) + 1, 6700417,
+                                        1ull << 63, (1ull << 63) + 1, ~std::uint64_t(0) - 1, ~std::uint64_t(0)};
+    std::mt19937_64 rng(11);
+    for (int i = 0; i < 64; ++i) {
+        divisors.push_back(rng() >> i | 1u);
+    }
+    std::vector<std::uint64_t> dividends{0, 1, 2, 999, 1000, 1001, 1ull << 63, ~std::uint64_t(0), ~std::uint64_t(0) - 1};
+
+    for (auto divisor : divisors) {
+        detail::UnsignedReciprocal const reciprocal(divisor);
+        for (auto dividend : dividends) {
+            REQUIRE(reciprocal.Divide(dividend) == dividend / divisor);
+        }
+        for (int i = 0; i < 200; ++i) {
+            auto const dividend = rng() >> (i % 64);
+            REQUIRE(reciprocal.Divide(dividend) == dividend / divisor);
+            // Multiples and their neighbours are the critical values
+            auto const multiple = (dividend / divisor) * divisor;
+            REQUIRE(reciprocal.Divide(multiple) == multiple / divisor);
+            REQUIRE(reciprocal.Divide(multiple - 1) == (multiple - 1) / divisor);
+        }
+    }
+}
+
+TEST_CASE("PreparedDivisor_SignedDivide")
+{
+    std::int64_t const min = std::numeric_limits<std::int64_t>::min();
+    std::int64_t const max = std::numeric_limits<std::int64_t>::max();
+    std::mt19937_64 rng(5);
+    for (std::int64_t raw : {std::int64_t(1), std::int64_t(-2), std::int64_t(3), std::int64_t(-1000), max, min + 1}) {
+        PreparedDivisor<Ohm64> const divisor(Ohm64::From<Prefix::Micro>(raw));
+        for (std::int64_t dividend : {std::int64_t(0), std::int64_t(-7), std::int64_t(7), max, min + 1}) {
+            REQUIRE(divisor.Divide(dividend) == dividend / raw);
+        }
+        for (int i = 0; i < 1000; ++i) {
+            auto const dividend = static_cast<std::int64_t>(rng()) >> (i % 64);
+            REQUIRE(divisor.Divide(dividend) == dividend / raw);
+        }
+    }
+}
+
+TEST_CASE("PreparedDivisor_UnitDivMatchesUnitDiv")
+{
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<int> any(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+
+    std::vector<Ohm> shunts{1_mOhm, 100_mOhm, 3_Ohm, Ohm::From<Prefix::Milli>(-7), Ohm::From<Prefix::Milli>(-1),
+                            Ohm::From<Prefix::Milli>(std::numeric_limits<int>::max()),
+                            Ohm::From<Prefix::Milli>(std::numeric_limits<int>::min())};
+    UnitArray<Volt> voltages(1000);
+    for (auto &voltage : voltages) {
+        voltage = Volt::From<Prefix::Milli>(any(rng) >> (rng() % 32));
+    }
+    voltages[0] = Volt::From<Prefix::Milli>(std::numeric_limits<int>::min());
+    voltages[1] = Volt::From<Prefix::Milli>(std::numeric_limits<int>::max());
+
+    for (auto shunt : shunts) {
+        PreparedDivisor<Ohm> const prepared(shunt);
+        REQUIRE(prepared.Divisor() == shunt);
+        for (auto voltage : voltages) {
+            // Volt / Ohm: the decade correction multiplies the dividend by 10^6
+            REQUIRE((UnitDiv<IntegralValueSystem, Ampere>(voltage, prepared)
+                     == UnitDiv<IntegralValueSystem, Ampere>(voltage, shunt)));
+            REQUIRE((UnitDiv<IntegralValueSystem, AmpereSat>(voltage, prepared)
+                     == UnitDiv<IntegralValueSystem, AmpereSat>(voltage, shunt)));
+        }
+    }
+}
+
+TEST_CASE("PreparedDivisor_NegativeDecadeCorrection")
+{
+    // Joule (mJ) / Second (us) -> Watt (mW): the dividend is divided by 10^3 before the division
+    std::mt19937 rng(23);
+    std::uniform_int_distribution<int> any(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+    for (int i = 0; i < 2000; ++i) {
+        auto const energy = Joule::From<Prefix::Milli>(any(rng));
+        auto const interval = Second::From<Prefix::Micro>((any(rng) >> (i % 31)) | 1);
+        REQUIRE((UnitDiv<IntegralValueSystem, Watt>(energy, PreparedDivisor<Second>(interval))
+                 == UnitDiv<IntegralValueSystem, Watt>(energy, interval)));
+    }
+}
+
+TEST_CASE("PreparedDivisor_MinusOneFollowsPolicy")
+{
+    PreparedDivisor<Ohm> const minusOne(Ohm::From<Prefix::Milli>(-1));
+    auto const minimum = Volt::From<Prefix::Milli>(std::numeric_limits<int>::min());
+    REQUIRE((UnitDiv<IntegralValueSystem, AmpereSat>(minimum, minusOne).To<Prefix::Micro>()
+             == std::numeric_limits<int>::max()));
+    REQUIRE((UnitDiv<IntegralValueSystem, Ampere>(minimum, minusOne)
+             == UnitDiv<IntegralValueSystem, Ampere>(minimum, Ohm::From<Prefix::Milli>(-1))));
+}
+
+TEST_CASE("PreparedDivisor_Batch")
+{
+    UnitArray<Volt> voltages(37);
+    for (std::size_t i = 0; i < voltages.size(); ++i) {
+        voltages[i] = Volt::From<Prefix::Milli>(static_cast<int>(i * 997) - 15000);
+    }
+    UnitArray<Ampere> expected(voltages.size());
+    UnitArray<Ampere> currents(voltages.size());
+
+    PreparedDivisor<Ohm> const shunt(150_mOhm);
+    UnitDivBatch<IntegralValueSystem, Ampere>(voltages.Span(), shunt, currents.Span());
+    for (std::size_t i = 0; i < voltages.size(); ++i) {
+        expected[i] = voltages[i] / 150_mOhm;
+    }
+    REQUIRE(std::equal(currents.begin(), currents.end(), expected.begin()));
+}
@@ -0,0 +1,233 @@
+#include <catch.hpp>
+#include <IntegralUnits/Conversions.hpp>
+#include <IntegralUnits/IntegralRatio.hpp>
+#include <LightUnits/Ratio.hpp>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+using namespace LightUnits;
+
+std::ostream& operator << ( std::ostream& os, IntegralRatio const& value ) {
+    os << value.Raw() << " (Q16)";
+    return os;
+}
+
+static_assert(IntegralRatio::OneRaw() == 65536, "");
+static_assert(RatioOf(1_A, 4_A) == IntegralRatio::FromRaw(16384), "UnitRatio has to be usable in constant expressions");
+
+TEST_CASE("Ratio_SameUnitIsOne")
+{
+    REQUIRE(RatioOf(3_V, 3_V) == IntegralRatio::FromInteger(1));
+}
+
+TEST_CASE("Ratio_Fraction")
+{
+    REQUIRE(RatioOf(3_V, 4_V) == IntegralRatio::FromRaw(49152));
+    REQUIRE(RatioOf(-3_V, 4_V) == IntegralRatio::FromRaw(-49152));
+    REQUIRE(RatioOf(5_A, 2_A) == IntegralRatio::FromRaw(163840));
+}
+
+TEST_CASE("Ratio_TruncatesTowardsZero")
+{
+    // 1/3 = 21845.33 / 2^16
+    REQUIRE(RatioOf(1_mV, 3_mV) == IntegralRatio::FromRaw(21845));
+    REQUIRE(RatioOf(-1_mV, 3_mV) == IntegralRatio::FromRaw(-21845));
+}
+
+TEST_CASE("Ratio_LargeRawValuesKeepPrecision")
+{
+    // Raw values close to int32 max, where the float path loses digits
+    auto const x = Ampere::From<Prefix::Micro>(2000000001);
+    auto const y = Ampere::From<Prefix::Micro>(2000000000);
+    REQUIRE(RatioOf(x, y) == IntegralRatio::FromInteger(1));
+    REQUIRE(x * RatioOf(y, y) == x);
+}
+
+struct VoltMicroIntegral
+{
+    static LightUnits::Prefix const BasePrefix = LightUnits::Prefix::Micro;
+    typedef std::int32_t ValueType;
+};
+
+using VoltMicro = LightUnits::BaseUnit<LightUnits::Volt_t, VoltMicroIntegral>;
+
+TEST_CASE("Ratio_DifferentBasePrefixes")
+{
+    auto const fine = VoltMicro::From<Prefix::Micro>(500);
+    REQUIRE(UnitRatio<IntegralValueSystem, IntegralRatio>(1_mV, fine) == IntegralRatio::FromInteger(2));
+    REQUIRE(UnitRatio<IntegralValueSystem, IntegralRatio>(fine, 1_mV) == IntegralRatio::FromRaw(32768));
+}
+
+struct VoltMilliSaturatingRatio
+{
+    static LightUnits::Prefix const BasePrefix = LightUnits::Prefix::Milli;
+    typedef std::int32_t ValueType;
+    typedef SaturateOverflow OverflowPolicy;
+};
+
+struct VoltMilliTrappingRatio
+{
+    static LightUnits::Prefix const BasePrefix = LightUnits::Prefix::Milli;
+    typedef std::int32_t ValueType;
+    typedef TrapOverflow OverflowPolicy;
+};
+
+using VoltSat = LightUnits::BaseUnit<LightUnits::Volt_t, VoltMilliSaturatingRatio>;
+using VoltTrap = LightUnits::BaseUnit<LightUnits::Volt_t, VoltMilliTrappingRatio>;
+
+static void ThrowOnRatioOverflow(char const *operation)
+{
+    throw std::overflow_error(operation);
+}
+
+TEST_CASE("Ratio_OutOfRangeFollowsOverflowPolicy")
+{
+    // 40000 exceeds the integer part of Q16 in 32 bits (max 32767.99998)
+    auto const big = VoltSat::From<Prefix::One>(40000);
+    auto const one = VoltSat::From<Prefix::One>(1);
+    auto const max = IntegralRatio::FromRaw(std::numeric_limits<int>::max());
+    auto const min = IntegralRatio::FromRaw(std::numeric_limits<int>::min());
+    REQUIRE(UnitRatio<IntegralValueSystem, IntegralRatio>(big, one) == max);
+    REQUIRE(UnitRatio<IntegralValueSystem, IntegralRatio>(-big, one) == min);
+    REQUIRE(IntegralRatio::FromInteger<SaturateOverflow>(40000) == max);
+    REQUIRE(IntegralRatio::FromInteger<SaturateOverflow>(-40000) == min);
+    REQUIRE(IntegralRatio::FromInteger<SaturateOverflow>(-3) == IntegralRatio::FromInteger(-3));
+
+    OverflowTrapHandler const previous = SetOverflowTrapHandler(&ThrowOnRatioOverflow);
+    REQUIRE_THROWS_AS((UnitRatio<IntegralValueSystem, IntegralRatio>(
+            VoltTrap::From<Prefix::One>(40000), VoltTrap::From<Prefix::One>(1))), std::overflow_error);
+    REQUIRE_THROWS_AS(IntegralRatio::FromInteger<TrapOverflow>(40000), std::overflow_error);
+    SetOverflowTrapHandler(previous);
+}
+
+TEST_CASE("ApplyRatio_ScalesUnit")
+{
+    auto const half = IntegralRatio::FromRaw(32768);
+    auto res = 10_V * half;
+    static_assert(std::is_same<decltype(res), Volt>::value, "Unit times Ratio has to be of type Unit");
+    REQUIRE(res == 5_V);
+    REQUIRE(half * 3_mV == 1_mV);
+    REQUIRE(-3_mV * half == -1_mV);
+}
+
+TEST_CASE("ApplyRatio_RoundTrip")
+{
+    auto const efficiency = RatioOf(800_mA, 1_A);
+    REQUIRE(efficiency == IntegralRatio::FromFloat(0.8f));
+    // 0.8 is not exactly representable in Q16 (52428 / 2^16), the product is truncated
+    REQUIRE(2_A * efficiency == 1599975_uA);
+    REQUIRE(2_A * RatioOf(750_mA, 1_A) == 1500_mA);
+}
+
+TEST_CASE("Ratio_FloatConversion")
+{
+    REQUIRE(IntegralRatio::FromFloat(0.25f).ToFloat() == 0.25f);
+    REQUIRE(IntegralRatio::FromFloat(-1.5f) == -IntegralRatio::FromRaw(98304));
+}
+
+TEST_CASE("UnitRatioBatch_MatchesScalar")
+{
+    std::vector<Volt> lhs = {1_V, 2_V, -3_V, 7_mV};
+    std::vector<Volt> rhs = {2_V, 2_V, 4_V, 3_mV};
+    std::vector<IntegralRatio> out(lhs.size());
+
+    UnitRatioBatch<IntegralValueSystem>(MakeSpan(lhs), MakeSpan(rhs), MakeSpan(out));
+
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        REQUIRE(out[i] == RatioOf(lhs[i], rhs[i]));
+    }
+}
+
+struct VoltKiloSaturating
+{
+    static LightUnits::Prefix const BasePrefix = LightUnits::Prefix::Kilo;
+    typedef std::int32_t ValueType;
+    typedef SaturateOverflow OverflowPolicy;
+};
+
+using KiloVoltSat = LightUnits::BaseUnit<LightUnits::Volt_t, VoltKiloSaturating>;
+
+TEST_CASE("Ratio_DividendWiderThanLargerType")
+{
+    // max kV in mV times 2^16 exceeds int64, the dividend is formed in Int128 where available
+    auto const max = IntegralRatio::FromRaw(std::numeric_limits<int>::max());
+    auto const min = IntegralRatio::FromRaw(std::numeric_limits<int>::min());
+    auto const milli = VoltSat::From<Prefix::Milli>(1);
+    REQUIRE(UnitRatio<IntegralValueSystem, IntegralRatio>(std::numeric_limits<KiloVoltSat>::max(), milli) == max);
+    REQUIRE(UnitRatio<IntegralValueSystem, IntegralRatio>(std::numeric_limits<KiloVoltSat>::min(), milli) == min);
+
+    // In range, but 2000 kV / 1 mV * 2^32 exceeds int64 before the division
+    using Q32 = Ratio<std::int64_t, 32>;
+    auto const ratio = UnitRatio<IntegralValueSystem, Q32>(KiloVoltSat::From<Prefix::Kilo>(2000),
+                                                           VoltSat::From<Prefix::Milli>(3));
+    REQUIRE(ratio.Raw() == 2000000000LL * 4294967296LL / 3);
+}
+
+static_assert(detail::RatioSimdExact<IntegralRatio, VoltSat, VoltSat>::value, "");
+static_assert(detail::RatioSimdExact<IntegralRatio, VoltMicro, VoltSat>::value, "");
+static_assert(!detail::RatioSimdExact<IntegralRatio, VoltSat, VoltMicro>::value, "Dividend exceeds 2^51");
+
+TEST_CASE("UnitRatioBatch_RandomMatchesScalar")
+{
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> wide(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+    std::uniform_int_distribution<int> narrow(-100000, 100000);
+    std::vector<VoltSat> lhs;
+    std::vector<VoltSat> rhs;
+    std::vector<VoltMicro> rhsMicro;
+    for (int i = 0; i < 20001; ++i) {
+        lhs.push_back(VoltSat::From<Prefix::Milli>(i % 3 == 0 ? wide(rng) : narrow(rng)));
+        int const divisor = (i % 5 == 0) ? narrow(rng) / 1000 : wide(rng);
+        rhs.push_back(VoltSat::From<Prefix::Milli>(divisor == 0 ? 1 : divisor));
+        rhsMicro.push_back(VoltMicro::From<Prefix::Micro>(divisor == 0 ? -1 : divisor));
+    }
+    lhs[0] = std::numeric_limits<VoltSat>::min();
+    rhs[0] = VoltSat::From<Prefix::Milli>(-1);
+
+    std::vector<IntegralRatio> out(lhs.size());
+    UnitRatioBatch<IntegralValueSystem>(MakeSpan(lhs), MakeSpan(rhs), MakeSpan(out));
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        REQUIRE(out[i] == UnitRatio<IntegralValueSystem, IntegralRatio>(lhs[i], rhs[i]));
+    }
+
+    // Different prefixes: in double for uV / mV (divisor scaled by 1000), scalar for mV / uV
+    std::vector<VoltMicro> lhsMicro;
+    for (auto const &value : lhs) {
+        lhsMicro.push_back(VoltMicro::From<Prefix::Micro>(value.To<Prefix::Milli>()));
+    }
+    UnitRatioBatch<IntegralValueSystem>(MakeSpan(lhsMicro), MakeSpan(rhs), MakeSpan(out));
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        REQUIRE(out[i] == UnitRatio<IntegralValueSystem, IntegralRatio>(lhsMicro[i], rhs[i]));
+    }
+    UnitRatioBatch<IntegralValueSystem>(MakeSpan(lhs), MakeSpan(rhsMicro), MakeSpan(out));
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        REQUIRE(out[i] == UnitRatio<IntegralValueSystem, IntegralRatio>(lhs[i], rhsMicro[i]));
+    }
+}
+
+TEST_CASE("ApplyRatioBatch_SingleRatio")
+{
+    std::vector<Ampere> in = {1_A, 2_mA, -4_uA, 0_A};
+    std::vector<Ampere> out(in.size());
+
+    ApplyRatioBatch<IntegralValueSystem>(MakeSpan(in), IntegralRatio::FromRaw(32768), MakeSpan(out));
+
+    REQUIRE(out[0] == 500_mA);
+    REQUIRE(out[1] == 1_mA);
+    REQUIRE(out[2] == -2_uA);
+    REQUIRE(out[3] == 0_A);
+}
+
+TEST_CASE("ApplyRatioBatch_InPlacePerElement")
+{
+    std::vector<Ampere> values = {1_A, 1_A};
+    std::vector<IntegralRatio> ratios = {IntegralRatio::FromInteger(2), IntegralRatio::FromRaw(16384)};
+
+    ApplyRatioBatch<IntegralValueSystem>(MakeSpan(values), MakeSpan(ratios), MakeSpan(values));
+
+    REQUIRE(values[0] == 2_A);
+    REQUIRE(values[1] == 250_mA);
+}
@@ -0,0 +1,225 @@
+#include <catch.hpp>
+#include <IntegralUnits/Conversions.hpp>
+#include <IntegralUnits/IntegralRatio.hpp>
+#include <LightUnits/Resampling.hpp>
+#include <LightUnits/UnitArray.hpp>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace LightUnits;
+
+static UnitArray<Ampere> RandomCurrents(std::size_t count, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(-2000000, 2000000);
+    UnitArray<Ampere> values(count);
+    for (auto &value : values) {
+        value = Ampere::From<Prefix::Micro>(dist(rng));
+    }
+    return values;
+}
+
+/// Feeds in to filter in blocks of the given sizes (cycling), returns all outputs
+template<typename Filter>
+static UnitArray<Ampere> ProcessInBlocks(Filter &filter, UnitArray<Ampere> const &in, std::vector<std::size_t> blocks,
+                                         std::size_t outputsPerInput = 1)
+{
+    UnitArray<Ampere> out(in.size() * outputsPerInput);
+    std::size_t consumed = 0;
+    std::size_t written = 0;
+    for (std::size_t b = 0; consumed < in.size(); ++b) {
+        std::size_t const size = std::min(blocks[b % blocks.size()], in.size() - consumed);
+        written += filter.Process(in.Span().subspan(consumed, size), out.Span().subspan(written));
+        consumed += size;
+    }
+    out.resize(written);
+    return out;
+}
+
+TEST_CASE("Resampling_CicDecimatorPassesDc")
+{
+    CicDecimator<IntegralValueSystem, Ampere, 3, 1000> cic;
+    UnitArray<Ampere> in(10000);
+    std::fill(in.begin(), in.end(), -1234567_uA);
+    UnitArray<Ampere> out(10);
+
+    REQUIRE(cic.OutputsFor(in.size()) == 10);
+    REQUIRE(cic.Process(in.Span(), out.Span()) == 10);
+
+    // Transient of Order outputs
+    REQUIRE(out[0] != -1234567_uA);
+    for (std::size_t i = 3; i < out.size(); ++i) {
+        REQUIRE(out[i] == -1234567_uA);
+    }
+}
+
+TEST_CASE("Resampling_CicDecimatorStreamingMatchesSingleBlock")
+{
+    auto const in = RandomCurrents(5000, 1);
+
+    CicDecimator<IntegralValueSystem, Ampere, 4, 10> single;
+    CicDecimator<IntegralValueSystem, Ampere, 4, 10> streamed;
+    auto const expected = ProcessInBlocks(single, in, {5000});
+    auto const actual = ProcessInBlocks(streamed, in, {7, 1, 33, 250});
+
+    REQUIRE(expected.size() == 500);
+    REQUIRE(actual.size() == 500);
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        REQUIRE(actual[i] == expected[i]);
+    }
+}
+
+TEST_CASE("Resampling_CicOrderOneIsBlockAverage")
+{
+    auto const in = RandomCurrents(400, 2);
+    CicDecimator<IntegralValueSystem, Ampere, 1, 8> cic;
+    auto const out = ProcessInBlocks(cic, in, {13});
+
+    REQUIRE(out.size() == 50);
+    for (std::size_t m = 0; m < out.size(); ++m) {
+        long long sum = 0;
+        for (std::size_t k = 0; k < 8; ++k) {
+            sum += in[8 * m + k].To<Prefix::Micro>();
+        }
+        REQUIRE(out[m] == Ampere::From<Prefix::Micro>(static_cast<int>(sum / 8)));
+    }
+}
+
+TEST_CASE("Resampling_CicInterpolatorPassesDc")
+{
+    CicInterpolator<IntegralValueSystem, Ampere, 2, 4> cic;
+    UnitArray<Ampere> const in = {3_A, 3_A, 3_A, 3_A};
+    UnitArray<Ampere> out(16);
+
+    REQUIRE(cic.Process(in.Span(), out.Span()) == 16);
+
+    // Linear ramp up during the first input, constant afterwards
+    REQUIRE(out[0] == 750_mA);
+    REQUIRE(out[3] == 3_A);
+    for (std::size_t i = 4; i < out.size(); ++i) {
+        REQUIRE(out[i] == 3_A);
+    }
+}
+
+TEST_CASE("Resampling_PolyphaseDecimatorMatchesDirectFir")
+{
+    std::vector<IntegralRatio> const taps = {
+            IntegralRatio::FromFloat(0.05f), IntegralRatio::FromFloat(0.2f), IntegralRatio::FromFloat(0.5f),
+            IntegralRatio::FromFloat(0.2f), IntegralRatio::FromFloat(0.05f), IntegralRatio::FromFloat(-0.01f)};
+    auto const in = RandomCurrents(3000, 3);
+    std::size_t const factor = 3;
+
+    PolyphaseDecimator<IntegralValueSystem, Ampere, int, 16> fir(taps, factor);
+    auto const out = ProcessInBlocks(fir, in, {1, 2, 100, 17});
+
+    REQUIRE(out.size() == 1000);
+    for (std::size_t m = 0; m < out.size(); ++m) {
+        long long acc = 0;
+        for (std::size_t k = 0; k < taps.size(); ++k) {
+            long long const n = static_cast<long long>(m * factor + factor - 1) - static_cast<long long>(k);
+            if (n >= 0) {
+                acc += static_cast<long long>(in[static_cast<std::size_t>(n)].To<Prefix::Micro>()) * taps[k].Raw();
+            }
+        }
+        REQUIRE(out[m] == Ampere::From<Prefix::Micro>(static_cast<int>(acc / IntegralRatio::OneRaw())));
+    }
+}
+
+TEST_CASE("Resampling_PolyphaseDecimatorAverages")
+{
+    std::vector<IntegralRatio> const taps(4, IntegralRatio::FromFloat(0.25f));
+    PolyphaseDecimator<IntegralValueSystem, Ampere, int, 16> fir(taps, 4);
+    UnitArray<Ampere> const in = {1_A, 2_A, 3_A, 4_A, 10_mA, 20_mA, 30_mA, 40_mA, 5_A};
+    UnitArray<Ampere> out(2);
+
+    REQUIRE(fir.OutputsFor(in.size()) == 2);
+    REQUIRE(fir.Process(in.Span(), out.Span()) == 2);
+    REQUIRE(out[0] == 2500_mA);
+    REQUIRE(out[1] == 25_mA);
+    REQUIRE(fir.OutputsFor(3) == 1);
+}
+
+TEST_CASE("Resampling_PolyphaseInterpolatorIsLinearInterpolation")
+{
+    // Triangle of gain 2: every second output is the input, the others are the means of neighbours
+    std::vector<IntegralRatio> const taps = {
+            IntegralRatio::FromFloat(0.5f), IntegralRatio::FromInteger(1), IntegralRatio::FromFloat(0.5f)};
+    PolyphaseInterpolator<IntegralValueSystem, Ampere, int, 16> fir(taps, 2);
+    UnitArray<Ampere> const in = {2_A, 4_A, 8_A, -2_A};
+
+    auto const out = ProcessInBlocks(fir, in, {1, 3}, 2);
+
+    REQUIRE(out.size() == 8);
+    REQUIRE(out[0] == 1_A);
+    REQUIRE(out[1] == 2_A);
+    REQUIRE(out[2] == 3_A);
+    REQUIRE(out[3] == 4_A);
+    REQUIRE(out[4] == 6_A);
+    REQUIRE(out[5] == 8_A);
+    REQUIRE(out[6] == 3_A);
+    REQUIRE(out[7] == -2_A);
+}
+
+#if defined(LIGHTUNITS_HAS_INT128)
+
+struct AmpereNano64 {
+    static Prefix const BasePrefix = Prefix::Nano;
+    typedef std::int64_t ValueType;
+};
+
+using Ampere64 = BaseUnit<Ampere_t, AmpereNano64>;
+
+TEST_CASE("Resampling_CicOnInt64UnitsAccumulatesInInt128")
+{
+    // 64 bit samples leave no headroom in int64, the integrators run in Int128
+    using Decimator = CicDecimator<IntegralValueSystem, Ampere64, 3, 16>;
+    using Interpolator = CicInterpolator<IntegralValueSystem, Ampere64, 2, 4>;
+    static_assert(std::is_same<Decimator::AccType, Int128>::value, "");
+
+    auto const dc = Ampere64::From<Prefix::Nano>(-4000000000000000000);
+    UnitArray<Ampere64> in(160);
+    std::fill(in.begin(), in.end(), dc);
+
+    Decimator decimator;
+    UnitArray<Ampere64> decimated(10);
+    REQUIRE(decimator.Process(in.Span(), decimated.Span()) == 10);
+    for (std::size_t i = 3; i < decimated.size(); ++i) {
+        REQUIRE(decimated[i] == dc);
+    }
+
+    Interpolator interpolator;
+    UnitArray<Ampere64> interpolated(in.size() * 4);
+    REQUIRE(interpolator.Process(in.Span(), interpolated.Span()) == interpolated.size());
+    REQUIRE(interpolated[interpolated.size() - 1] == dc);
+}
+
+#endif
+
+TEST_CASE("Resampling_DotProductOfInt32MatchesWideProducts")
+{
+    std::mt19937 rng(12);
+    std::uniform_int_distribution<std::int32_t> full(std::numeric_limits<std::int32_t>::min(),
+                                                     std::numeric_limits<std::int32_t>::max());
+    std::vector<std::int32_t> samples(67);
+    std::vector<std::int32_t> coefficients(67);
+    for (int round = 0; round < 200; ++round) {
+        for (std::size_t k = 0; k < samples.size(); ++k) {
+            samples[k] = full(rng) >> (round % 32);
+            coefficients[k] = full(rng) >> (k % 32);
+        }
+        samples[0] = std::numeric_limits<std::int32_t>::min();
+        coefficients[1] = std::numeric_limits<std::int32_t>::min();
+
+        // Compared modulo 2^64: sums of full scale products exceed int64
+        std::uint64_t expected = 0;
+        for (std::size_t count = 0; count <= samples.size(); ++count) {
+            auto const acc = detail::DotProduct<std::int64_t>(samples.data(), coefficients.data(), count);
+            REQUIRE(static_cast<std::uint64_t>(acc) == expected);
+            if (count < samples.size()) {
+                expected += static_cast<std::uint64_t>(static_cast<std::int64_t>(samples[count]) * coefficients[count]);
+            }
+        }
+    }
+}
@@ -0,0 +1,182 @@
+#include <catch.hpp>
+#include <IntegralUnits/Conversions.hpp>
+#include <LightUnits/Sort.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace LightUnits;
+
+static std::vector<Ampere> RandomCurrents(std::size_t count, int low, int high, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(low, high);
+    std::vector<Ampere> values;
+    for (std::size_t i = 0; i < count; ++i) {
+        values.push_back(Ampere::From<Prefix::Micro>(dist(rng)));
+    }
+    return values;
+}
+
+TEST_CASE("RadixSort_MatchesStdSort")
+{
+    auto values = RandomCurrents(10000, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), 1);
+    values.push_back(std::numeric_limits<Ampere>::min());
+    values.push_back(std::numeric_limits<Ampere>::max());
+    values.push_back(0_A);
+    auto expected = values;
+
+    RadixSort(MakeSpan(values));
+    std::sort(expected.begin(), expected.end());
+
+    REQUIRE(values == expected);
+}
+
+TEST_CASE("RadixSort_SmallRangeSkipsPasses")
+{
+    auto values = RandomCurrents(1000, -100, 100, 2);
+    auto expected = values;
+
+    RadixSort(MakeSpan(values));
+    std::sort(expected.begin(), expected.end());
+
+    REQUIRE(values == expected);
+}
+
+TEST_CASE("RadixSort_EmptyAndSingle")
+{
+    std::vector<Volt> empty;
+    RadixSort(MakeSpan(empty));
+
+    std::vector<Volt> single = {5_V};
+    RadixSort(MakeSpan(single));
+    REQUIRE(single[0] == 5_V);
+}
+
+TEST_CASE("RadixSort_PayloadFollowsValuesStably")
+{
+    std::vector<Volt> values = {3_V, -1_V, 3_V, 0_V, -1_V};
+    std::vector<Second> timestamps = {0_ms, 1_ms, 2_ms, 3_ms, 4_ms};
+
+    RadixSort(MakeSpan(values), MakeSpan(timestamps));
+
+    REQUIRE(values == std::vector<Volt>({-1_V, -1_V, 0_V, 3_V, 3_V}));
+    REQUIRE(timestamps == std::vector<Second>({1_ms, 4_ms, 3_ms, 0_ms, 2_ms}));
+}
+
+TEST_CASE("ParallelRadixSort_MatchesSequential")
+{
+    auto values = RandomCurrents(300000, -50000000, 50000000, 3);
+    std::vector<std::uint32_t> indices(values.size());
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        indices[i] = static_cast<std::uint32_t>(i);
+    }
+    auto sequential = values;
+    auto sequentialIndices = indices;
+
+    ParallelRadixSort(MakeSpan(values), MakeSpan(indices), 4);
+    RadixSort(MakeSpan(sequential), MakeSpan(sequentialIndices));
+
+    REQUIRE(values == sequential);
+    REQUIRE(indices == sequentialIndices);
+
+    auto withoutPayload = RandomCurrents(200000, -1000, 1000, 4);
+    auto expected = withoutPayload;
+    ParallelRadixSort(MakeSpan(withoutPayload), 3);
+    std::sort(expected.begin(), expected.end());
+    REQUIRE(withoutPayload == expected);
+
+    // Only the lowest byte differs: all later passes are skipped, the result stays in the scratch buffer
+    auto lowByte = RandomCurrents(100003, 0, 255, 9);
+    auto lowByteExpected = lowByte;
+    ParallelRadixSort(MakeSpan(lowByte), 7);
+    std::sort(lowByteExpected.begin(), lowByteExpected.end());
+    REQUIRE(lowByte == lowByteExpected);
+}
+
+TEST_CASE("SelectNth_MatchesSortedPosition")
+{
+    auto values = RandomCurrents(5001, -1000000, 1000000, 5);
+    auto const original = values;
+    auto sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+
+    for (std::size_t n : {std::size_t(0), std::size_t(1), std::size_t(2500), std::size_t(4950), std::size_t(5000)}) {
+        REQUIRE(SelectNth(MakeSpan(original), n) == sorted[n]);
+    }
+    REQUIRE(values == original);
+}
+
+TEST_CASE("SelectNth_WithDuplicates")
+{
+    std::vector<Volt> const values = {2_V, 1_V, 2_V, 2_V, -7_V, 2_V};
+    REQUIRE(SelectNth(MakeSpan(values), 0) == -7_V);
+    REQUIRE(SelectNth(MakeSpan(values), 1) == 1_V);
+    REQUIRE(SelectNth(MakeSpan(values), 5) == 2_V);
+}
+
+TEST_CASE("NthElement_PartitionsAroundValue")
+{
+    auto values = RandomCurrents(2000, -500, 500, 6);
+    auto sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+
+    auto const median = NthElement(MakeSpan(values), 1000);
+
+    REQUIRE(median == sorted[1000]);
+    REQUIRE(values[1000] == median);
+    REQUIRE(std::all_of(values.begin(), values.begin() + 1000, [&](Ampere a) { return a <= median; }));
+    REQUIRE(std::all_of(values.begin() + 1001, values.end(), [&](Ampere a) { return a >= median; }));
+}
+
+TEST_CASE("TopK_LargestInDescendingOrder")
+{
+    auto const values = RandomCurrents(10000, -100000, 100000, 7);
+    auto sorted = values;
+    std::sort(sorted.begin(), sorted.end(), [](Ampere a, Ampere b) { return a > b; });
+
+    std::vector<Ampere> top(10);
+    TopK(MakeSpan(values), 10, MakeSpan(top));
+
+    REQUIRE(top == std::vector<Ampere>(sorted.begin(), sorted.begin() + 10));
+}
+
+TEST_CASE("TopK_WithPayloadAndTies")
+{
+    std::vector<Volt> const values = {1_V, 5_V, 3_V, 5_V, 4_V, 5_V};
+    std::vector<Second> const timestamps = {0_s, 1_s, 2_s, 3_s, 4_s, 5_s};
+
+    std::vector<Volt> top(2);
+    std::vector<Second> when(2);
+    TopK(MakeSpan(values), MakeSpan(timestamps), 2, MakeSpan(top), MakeSpan(when));
+
+    REQUIRE(top == std::vector<Volt>({5_V, 5_V}));
+    REQUIRE(when == std::vector<Second>({1_s, 3_s}));
+
+    std::vector<Volt> four(4);
+    std::vector<Second> fourWhen(4);
+    TopK(MakeSpan(values), MakeSpan(timestamps), 4, MakeSpan(four), MakeSpan(fourWhen));
+    REQUIRE(four == std::vector<Volt>({5_V, 5_V, 5_V, 4_V}));
+    REQUIRE(fourWhen == std::vector<Second>({1_s, 3_s, 5_s, 4_s}));
+}
+
+TEST_CASE("TopK_TiesKeepOrderOfOccurrence")
+{
+    auto const values = RandomCurrents(5000, -20, 20, 8);
+    std::vector<std::uint32_t> indices(values.size());
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        indices[i] = static_cast<std::uint32_t>(i);
+    }
+
+    std::vector<Ampere> top(1000);
+    std::vector<std::uint32_t> topIndices(top.size());
+    TopK(MakeSpan(values), MakeSpan(indices), top.size(), MakeSpan(top), MakeSpan(topIndices));
+
+    auto expected = indices;
+    std::stable_sort(expected.begin(), expected.end(),
+                     [&](std::uint32_t a, std::uint32_t b) { return values[a] > values[b]; });
+    expected.resize(top.size());
+    REQUIRE(topIndices == expected);
+}
@@ -0,0 +1,115 @@
+#include <catch.hpp>
+#include <IntegralUnits/Conversions.hpp>
+#include <LightUnits/UnitFrame.hpp>
+
+using namespace LightUnits;
+
+using Capture = UnitFrame<Second, Volt, Ampere, Watt, Joule>;
+
+enum CaptureColumn : std::size_t {
+    Time = 0, Voltage, Current, Power, Energy
+};
+
+static Capture ConstantLoad(std::size_t rows)
+{
+    Capture frame;
+    frame.Reserve(rows);
+    for (std::size_t i = 0; i < rows; ++i) {
+        frame.AppendRow(static_cast<int>(i) * 1_ms, 2_V, 3_A, 0_W, 0_J);
+    }
+    return frame;
+}
+
+TEST_CASE("UnitFrame_AppendRowFillsAllColumns")
+{
+    Capture frame;
+    frame.AppendRow(1_ms, 230_V, 2_A, 0_W, 0_J);
+    frame.AppendRow(2_ms, 231_V, 3_A, 0_W, 0_J);
+
+    REQUIRE(frame.Rows() == 2);
+    REQUIRE(frame.Column<Time>()[1] == 2_ms);
+    REQUIRE(frame.Column<Voltage>()[0] == 230_V);
+    REQUIRE(frame.Column<Current>().size() == 2);
+    static_assert(Capture::ColumnCount == 5, "");
+    static_assert(std::is_same<Capture::ColumnType<Power>, Watt>::value, "");
+}
+
+TEST_CASE("UnitFrame_ResizeZeroInitializes")
+{
+    Capture frame(3);
+    REQUIRE(frame.Rows() == 3);
+    REQUIRE(frame.Column<Energy>()[2] == 0_J);
+}
+
+TEST_CASE("UnitFrame_DeriveProduct")
+{
+    auto frame = ConstantLoad(10);
+    DeriveProduct<IntegralValueSystem, Power, Voltage, Current>(frame);
+
+    for (auto const p : frame.Column<Power>()) {
+        REQUIRE(p == 6_W);
+    }
+}
+
+TEST_CASE("UnitFrame_DeriveIntegral")
+{
+    auto frame = ConstantLoad(1001);
+    DeriveProduct<IntegralValueSystem, Power, Voltage, Current>(frame);
+    DeriveIntegral<IntegralValueSystem, Energy, Power, Time>(frame);
+
+    REQUIRE(frame.Column<Energy>()[0] == 0_J);
+    REQUIRE(frame.Column<Energy>()[1] == 6_mJ);
+    REQUIRE(frame.Column<Energy>()[1000] == 6_J);
+}
+
+TEST_CASE("UnitFrame_TrapezoidDoesNotAccumulateTruncation")
+{
+    // 1 mW for 1 us per step is 1 nJ, far below the resolution of Joule (mJ)
+    UnitFrame<Second, Watt, Joule> frame;
+    for (int i = 0; i <= 2000000; ++i) {
+        frame.AppendRow(i * 1_us, 1_mW, 0_J);
+    }
+    DeriveIntegral<IntegralValueSystem, 2, 1, 0>(frame);
+
+    REQUIRE(frame.Column<2>()[999999] == 0_J);
+    REQUIRE(frame.Column<2>()[2000000] == 2_mJ);
+}
+
+TEST_CASE("UnitFrame_FusedMatchesSeparatePasses")
+{
+    // More rows than one block, with varying values
+    Capture fused;
+    for (int i = 0; i < 5000; ++i) {
+        fused.AppendRow(i * 250_us, (i % 17) * 100_mV + 1_V, (i % 5) * 10_mA - 20_mA, 0_W, 0_J);
+    }
+    auto separate = fused;
+
+    DerivePowerAndEnergy<IntegralValueSystem, Power, Energy, Voltage, Current, Time>(fused);
+    DeriveProduct<IntegralValueSystem, Power, Voltage, Current>(separate);
+    DeriveIntegral<IntegralValueSystem, Energy, Power, Time>(separate);
+
+    for (std::size_t row = 0; row < fused.Rows(); ++row) {
+        REQUIRE(fused.Column<Power>()[row] == separate.Column<Power>()[row]);
+        REQUIRE(fused.Column<Energy>()[row] == separate.Column<Energy>()[row]);
+    }
+}
+
+TEST_CASE("UnitFrame_SelectProducesIndices")
+{
+    Capture frame;
+    frame.AppendRow(0_ms, 230_V, 1_A, 0_W, 0_J);
+    frame.AppendRow(1_ms, 180_V, 2_A, 0_W, 0_J);
+    frame.AppendRow(2_ms, 235_V, 7_A, 0_W, 0_J);
+    frame.AppendRow(3_ms, 170_V, 9_A, 0_W, 0_J);
+
+    auto const undervoltage = frame.Select<Voltage>([](Volt v) { return v < 200_V; });
+    REQUIRE(undervoltage == SelectionVector({1, 3}));
+
+    auto const both = frame.Select<Current>(undervoltage, [](Ampere i) { return i > 5_A; });
+    REQUIRE(both == SelectionVector({3}));
+
+    auto const currents = frame.Gather<Current>(undervoltage);
+    REQUIRE(currents.size() == 2);
+    REQUIRE(currents[0] == 2_A);
+    REQUIRE(currents[1] == 9_A);
+}
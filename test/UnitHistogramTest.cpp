@@ -0,0 +1,137 @@
+#include <catch.hpp>
+#include <IntegralUnits/Conversions.hpp>
+#include <LightUnits/UnitHistogram.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace LightUnits;
+
+static_assert(detail::SubBucketBits(1) == 5, "");
+static_assert(detail::SubBucketBits(3) == 11, "");
+
+/// Relative distance of the histogram result to the exact value
+template<typename Unit>
+static double RelativeError(Unit const& approx, Unit const& exact)
+{
+    auto const a = static_cast<double>(approx.template To<Unit::BasePrefix>());
+    auto const e = static_cast<double>(exact.template To<Unit::BasePrefix>());
+    return (a - e) / (e == 0.0 ? 1.0 : (e < 0 ? -e : e));
+}
+
+TEST_CASE("UnitHistogram_EmptyReturnsZero")
+{
+    UnitHistogram<Second> histogram;
+    REQUIRE(histogram.Count() == 0);
+    REQUIRE(histogram.ValueAtQuantile(0.5) == 0_s);
+}
+
+TEST_CASE("UnitHistogram_SmallValuesAreExact")
+{
+    UnitHistogram<Second> histogram;
+    for (int i = 1; i <= 1000; ++i) {
+        histogram.Record(i * 1_us);
+    }
+
+    REQUIRE(histogram.Count() == 1000);
+    REQUIRE(histogram.Min() == 1_us);
+    REQUIRE(histogram.Max() == 1_ms);
+    REQUIRE(histogram.ValueAtQuantile(0.5) == 500_us);
+    REQUIRE(histogram.ValueAtQuantile(0.99) == 990_us);
+    REQUIRE(histogram.ValueAtQuantile(1.0) == 1_ms);
+    REQUIRE(histogram.ValueAtQuantile(0.0) == 1_us);
+}
+
+TEST_CASE("UnitHistogram_LargeValuesKeepSignificantDigits")
+{
+    UnitHistogram<Second> histogram;
+    std::vector<Second> samples;
+    for (int i = 1; i <= 100000; ++i) {
+        samples.push_back(i * 17_us);
+        histogram.Record(samples.back());
+    }
+
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        auto const exact = samples[static_cast<std::size_t>(q * samples.size()) - 1];
+        auto const approx = histogram.ValueAtQuantile(q);
+        REQUIRE(RelativeError(approx, exact) >= 0.0);
+        REQUIRE(RelativeError(approx, exact) < 0.001);
+    }
+}
+
+TEST_CASE("UnitHistogram_NegativeValues")
+{
+    UnitHistogram<Ampere, 2> histogram;
+    histogram.Record(-5_A);
+    histogram.Record(-1_A);
+    histogram.Record(0_A);
+    histogram.Record(2_A, 2);
+
+    REQUIRE(histogram.Count() == 5);
+    REQUIRE(histogram.Min() == -5_A);
+    REQUIRE(histogram.ValueAtRank(1) <= -5_A * 0.99f);
+    REQUIRE(histogram.ValueAtRank(1) >= -5_A);
+    REQUIRE(histogram.ValueAtRank(2) <= -1_A * 0.99f);
+    REQUIRE(histogram.ValueAtRank(3) == 0_A);
+    REQUIRE(histogram.ValueAtRank(5) == 2_A);
+}
+
+TEST_CASE("UnitHistogram_ExtremeValues")
+{
+    UnitHistogram<Ampere> histogram;
+    histogram.Record(std::numeric_limits<Ampere>::min());
+    histogram.Record(std::numeric_limits<Ampere>::max());
+
+    REQUIRE(histogram.ValueAtRank(1) == std::numeric_limits<Ampere>::min());
+    REQUIRE(histogram.ValueAtRank(2) == std::numeric_limits<Ampere>::max());
+}
+
+TEST_CASE("UnitHistogram_BatchRecordAndMergeMatchScalar")
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(-2000000, 2000000);
+
+    std::vector<Ampere> samples;
+    for (int i = 0; i < 20000; ++i) {
+        samples.push_back(Ampere::From<Prefix::Micro>(dist(rng)));
+    }
+
+    UnitHistogram<Ampere> scalar;
+    for (auto const& sample : samples) {
+        scalar.Record(sample);
+    }
+
+    UnitHistogram<Ampere> first;
+    UnitHistogram<Ampere> second;
+    auto const span = MakeSpan(samples);
+    first.Record(span.first(5000));
+    second.Record(span.subspan(5000));
+    first.Merge(second);
+
+    REQUIRE(first.Count() == scalar.Count());
+    REQUIRE(first.Min() == scalar.Min());
+    REQUIRE(first.Max() == scalar.Max());
+
+    std::vector<double> const quantiles = {0.0, 0.01, 0.5, 0.99, 0.999, 1.0};
+    std::vector<Ampere> merged(quantiles.size());
+    first.ValuesAtQuantiles(MakeSpan(quantiles), MakeSpan(merged));
+
+    for (std::size_t i = 0; i < quantiles.size(); ++i) {
+        REQUIRE(merged[i] == scalar.ValueAtQuantile(quantiles[i]));
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto const p99 = samples[static_cast<std::size_t>(0.99 * samples.size()) - 1];
+    REQUIRE(RelativeError(scalar.ValueAtQuantile(0.99), p99) < 0.001);
+}
+
+TEST_CASE("UnitHistogram_Reset")
+{
+    UnitHistogram<Second> histogram;
+    histogram.Record(1_s);
+    histogram.Reset();
+    REQUIRE(histogram.Count() == 0);
+    histogram.Record(2_s);
+    REQUIRE(histogram.Min() == 2_s);
+}
@@ -1,3 +1,4 @@
+#include <LightUnits/Int128.hpp>
 #include <LightUnits/ValueSystem.hpp>
 #include <cstdint>
 
@@ -37,3 +38,10 @@ static_assert(
 static_assert(
         std::is_same<std::int64_t, MultiplicationResultHelper<Sys4, std::int32_t, std::int16_t>::type>::value,
         "");
+
+#if defined(LIGHTUNITS_HAS_INT128)
+using Sys5 = ValueSystem<std::int8_t, std::int16_t, std::int32_t, std::int64_t, Int128>;
+
+static_assert(std::is_same<Int128, MultiplicationResultHelper<Sys5, std::int64_t, std::int32_t>::type>::value, "");
+static_assert(std::is_same<Int128, LargerType<Sys5, std::int64_t>::type>::value, "");
+#endif